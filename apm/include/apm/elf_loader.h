@@ -86,12 +86,12 @@ class elf_loader: public program_loader {
   };
 
 private:
-  bool is_valid_format();
+  bool read_header(file_header& header);
 
 public:
   using program_loader::program_loader;
 
-  virtual bool load() override;
+  virtual bool load(program_image& image) override;
 };
 
 #endif // APM_ELF_LOADER_H_
@@ -0,0 +1,12 @@
+#ifndef APM_IMAGE_CACHE_H_
+#define APM_IMAGE_CACHE_H_
+
+#include <apm/program_loader.h>
+#include <fs/ipc.h>
+#include <memory>
+#include <string_view>
+
+std::shared_ptr<const program_image> lookup_image(std::string_view path, const fs_file_info& info);
+void                                 cache_image(std::string_view path, const fs_file_info& info, std::shared_ptr<const program_image> image);
+
+#endif // APM_IMAGE_CACHE_H_
@@ -7,6 +7,7 @@
 #define APM_MSG_TYPE_SETENV  4
 #define APM_MSG_TYPE_GETENV  5
 #define APM_MSG_TYPE_NEXTENV 6
+#define APM_MSG_TYPE_DUMPENV 7
 
 #define APM_CODE_S_OK           0
 #define APM_CODE_E_FAILURE      1
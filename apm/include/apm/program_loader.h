@@ -1,26 +1,44 @@
 #ifndef APM_PROGRAM_LOADER_H_
 #define APM_PROGRAM_LOADER_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <istream>
 #include <libcaprese/cap.h>
+#include <string>
+#include <vector>
 
 class task;
 
+struct program_segment {
+  uintptr_t   va;
+  size_t      size;
+  int         flags;
+  size_t      data_offset;
+  std::string data;
+};
+
+// A parsed executable. It holds everything needed to map the program, so it can be loaded again without the file.
+struct program_image {
+  uintptr_t                    entry;
+  std::vector<program_segment> segments;
+
+  size_t data_size() const noexcept;
+};
+
 class program_loader {
 protected:
-  std::reference_wrapper<task>         target_ref;
   std::reference_wrapper<std::istream> stream_ref;
 
-  virtual bool map_page(uintptr_t va, int level, int flags, const void* data = nullptr);
-
 public:
-  program_loader(std::reference_wrapper<task> target_ref, std::reference_wrapper<std::istream> stream_ref);
+  program_loader(std::reference_wrapper<std::istream> stream_ref);
 
   virtual ~program_loader();
 
-  virtual bool load() = 0;
+  virtual bool load(program_image& image) = 0;
 };
 
+bool map_program_image(task& target, const program_image& image);
+
 #endif // APM_PROGRAM_LOADER_H_
@@ -1,16 +1,23 @@
 #ifndef APM_TASK_MANAGER_H_
 #define APM_TASK_MANAGER_H_
 
+#include <apm/program_loader.h>
 #include <cstdint>
 #include <functional>
-#include <istream>
 #include <libcaprese/cap.h>
 #include <libcaprese/cxx/raii.h>
 #include <map>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
 
+// Environments are shared between a task and the children spawned from it until one of them changes a variable.
+struct env_snapshot {
+  std::map<std::string, std::string, std::less<>> vars;
+  std::string                                     packed; // "NAME=VALUE\0" entries, built on first use.
+};
+
 class task {
   caprese::unique_cap                             task_cap;
   caprese::unique_cap                             cap_space_cap;
@@ -19,7 +26,7 @@ class task {
   caprese::unique_cap                             mm_id_cap;
   caprese::unique_cap                             ep_cap;
   std::string                                     name;
-  std::map<std::string, std::string, std::less<>> env;
+  std::shared_ptr<env_snapshot>                   env;
   uint32_t                                        tid;
 
 public:
@@ -40,16 +47,18 @@ public:
   const std::string&         get_name() const noexcept;
   uint32_t                   get_tid() const noexcept;
 
-  bool set_env(std::string_view env, std::string_view value) noexcept;
-  bool get_env(std::string_view env, std::string& value) const noexcept;
-  bool next_env(std::string_view env, std::string& value) const noexcept;
+  bool               set_env(std::string_view env, std::string_view value) noexcept;
+  bool               get_env(std::string_view env, std::string& value) const noexcept;
+  bool               next_env(std::string_view env, std::string& value) const noexcept;
+  size_t             get_env_count() const noexcept;
+  const std::string& get_packed_env() const noexcept;
 
   void      set_register(uintptr_t reg, uintptr_t value) noexcept;
   uintptr_t get_register(uintptr_t reg) const noexcept;
 
   cap_t transfer_cap(cap_t cap) const noexcept;
 
-  bool load_program(std::reference_wrapper<std::istream> data);
+  bool load_program(const program_image& image);
 
   void kill() const;
   void switch_task() const;
@@ -57,7 +66,7 @@ public:
   void suspend() const;
 };
 
-bool  create_task(std::string_view name, std::reference_wrapper<std::istream> data, int flags, uint32_t parent_tid, const std::vector<std::string_view>& args);
+bool  create_task(std::string_view name, const program_image& image, int flags, uint32_t parent_tid, const std::vector<std::string_view>& args);
 bool  attach_task(std::string_view name, task_cap_t task_cap, endpoint_cap_t ep_cap);
 bool  task_exists(std::string_view name);
 bool  task_exists(uint32_t tid);
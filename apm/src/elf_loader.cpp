@@ -3,8 +3,9 @@
 #include <cstring>
 #include <iterator>
 #include <libcaprese/syscall.h>
-#include <memory>
 #include <mm/ipc.h>
+#include <utility>
+#include <vector>
 
 namespace {
   constexpr uintptr_t round_up(uintptr_t value, uintptr_t align) {
@@ -16,12 +17,10 @@ namespace {
   }
 } // namespace
 
-bool elf_loader::is_valid_format() {
+bool elf_loader::read_header(file_header& header) {
   std::istream& stream = stream_ref.get();
 
   stream.seekg(0);
-
-  file_header header;
   stream.read((char*)&header, sizeof(header));
 
   if (stream.fail()) [[unlikely]] {
@@ -52,54 +51,38 @@ bool elf_loader::is_valid_format() {
     return false;
   }
 
-  stream.seekg(header.e_phoff);
-  if (stream.fail()) [[unlikely]] {
-    return false;
-  }
-
-  for (size_t i = 0; i < header.e_phnum; ++i) {
-    program_header prog_header;
-    stream.read((char*)&prog_header, sizeof(prog_header));
-
-    if (stream.fail()) [[unlikely]] {
-      return false;
-    }
-
-    if (prog_header.p_type != segment_type::load) {
-      continue;
-    }
-
-    if (prog_header.p_filesz > prog_header.p_memsz) {
-      return false;
-    }
-  }
-
   return true;
 }
 
-bool elf_loader::load() {
-  if (!is_valid_format()) {
+bool elf_loader::load(program_image& image) {
+  file_header header;
+  if (!read_header(header)) [[unlikely]] {
     return false;
   }
 
   std::istream& stream = stream_ref.get();
-  stream.seekg(0);
 
-  file_header header;
-  stream.read((char*)&header, sizeof(header));
+  std::vector<program_header> prog_headers(header.e_phnum);
 
   stream.seekg(header.e_phoff);
+  stream.read((char*)prog_headers.data(), sizeof(program_header) * prog_headers.size());
 
-  std::unique_ptr<char[]> buf = std::make_unique<char[]>(KILO_PAGE_SIZE);
+  if (stream.fail()) [[unlikely]] {
+    return false;
+  }
 
-  for (size_t i = 0; i < header.e_phnum; ++i) {
-    program_header prog_header;
-    stream.read((char*)&prog_header, sizeof(program_header));
+  image.entry = header.e_entry;
+  image.segments.clear();
 
+  for (const auto& prog_header : prog_headers) {
     if (prog_header.p_type != segment_type::load) {
       continue;
     }
 
+    if (prog_header.p_filesz > prog_header.p_memsz) [[unlikely]] {
+      return false;
+    }
+
     bool readable   = static_cast<uint32_t>(prog_header.p_flags) & static_cast<uint32_t>(segment_flag::readable);
     bool writable   = static_cast<uint32_t>(prog_header.p_flags) & static_cast<uint32_t>(segment_flag::writable);
     bool executable = static_cast<uint32_t>(prog_header.p_flags) & static_cast<uint32_t>(segment_flag::executable);
@@ -115,52 +98,41 @@ bool elf_loader::load() {
       flags |= MM_VMAP_FLAG_EXEC;
     }
 
-    uintptr_t va_base = round_down(prog_header.p_vaddr, KILO_PAGE_SIZE);
-    uintptr_t offset  = prog_header.p_vaddr % KILO_PAGE_SIZE;
-    size_t    written = 0;
-
-    std::streampos pos = stream.tellg();
-    stream.seekg(prog_header.p_offset);
+    uintptr_t va_start = round_down(prog_header.p_vaddr, KILO_PAGE_SIZE);
+    uintptr_t data_end = round_up(prog_header.p_vaddr + prog_header.p_filesz, KILO_PAGE_SIZE);
+    uintptr_t va_end   = round_up(prog_header.p_vaddr + prog_header.p_memsz, KILO_PAGE_SIZE);
 
-    if (offset != 0) {
-      size_t len = std::min<size_t>(KILO_PAGE_SIZE - offset, prog_header.p_filesz);
+    if (prog_header.p_filesz > 0) {
+      std::string data(prog_header.p_filesz, '\0');
 
-      memset(buf.get(), 0, offset);
-      stream.read(buf.get() + offset, len);
-      memset(buf.get() + offset + len, 0, KILO_PAGE_SIZE - (offset + len));
+      stream.seekg(prog_header.p_offset);
+      stream.read(data.data(), data.size());
 
-      if (!map_page(va_base, KILO_PAGE, flags, buf.get())) {
+      if (stream.fail()) [[unlikely]] {
         return false;
       }
 
-      written += KILO_PAGE_SIZE - offset;
+      image.segments.push_back({
+          .va          = va_start,
+          .size        = data_end - va_start,
+          .flags       = flags,
+          .data_offset = prog_header.p_vaddr - va_start,
+          .data        = std::move(data),
+      });
+    } else {
+      data_end = va_start;
     }
 
-    while (written < prog_header.p_filesz) {
-      size_t len = std::min<size_t>(KILO_PAGE_SIZE, prog_header.p_filesz - written);
-
-      stream.read(buf.get(), len);
-      memset(buf.get() + len, 0, KILO_PAGE_SIZE - len);
-
-      if (!map_page(va_base + offset + written, KILO_PAGE, flags, buf.get())) {
-        return false;
-      }
-
-      written += KILO_PAGE_SIZE;
-    }
-
-    while (written < prog_header.p_memsz) {
-      if (!map_page(va_base + offset + written, KILO_PAGE, flags, nullptr)) {
-        return false;
-      }
-
-      written += KILO_PAGE_SIZE;
+    if (va_end > data_end) {
+      image.segments.push_back({
+          .va          = data_end,
+          .size        = va_end - data_end,
+          .flags       = flags,
+          .data_offset = 0,
+          .data        = {},
+      });
     }
-
-    stream.seekg(pos);
   }
 
-  target_ref.get().set_register(REG_PROGRAM_COUNTER, header.e_entry);
-
   return true;
 }
@@ -0,0 +1,69 @@
+#include <apm/image_cache.h>
+#include <map>
+#include <string>
+
+namespace {
+  // Images are evicted least recently used first once their file data exceeds this.
+  constexpr size_t max_cached_size = 0x800000;
+
+  struct cache_entry {
+    std::shared_ptr<const program_image> image;
+    size_t                               file_size;
+    uint64_t                             file_version;
+    uint64_t                             last_used;
+  };
+
+  std::map<std::string, cache_entry, std::less<>> image_cache;
+  size_t                                          cached_size;
+  uint64_t                                        use_count;
+
+  void evict(std::map<std::string, cache_entry, std::less<>>::iterator it) {
+    cached_size -= it->second.image->data_size();
+    image_cache.erase(it);
+  }
+} // namespace
+
+std::shared_ptr<const program_image> lookup_image(std::string_view path, const fs_file_info& info) {
+  auto it = image_cache.find(path);
+  if (it == image_cache.end()) {
+    return nullptr;
+  }
+
+  if (it->second.file_size != info.file_size || it->second.file_version != info.file_version) {
+    evict(it);
+    return nullptr;
+  }
+
+  it->second.last_used = ++use_count;
+
+  return it->second.image;
+}
+
+void cache_image(std::string_view path, const fs_file_info& info, std::shared_ptr<const program_image> image) {
+  // Without a version a changed file cannot be told apart from the cached one.
+  if (info.file_version == 0) {
+    return;
+  }
+
+  size_t size = image->data_size();
+  if (size > max_cached_size) [[unlikely]] {
+    return;
+  }
+
+  if (auto it = image_cache.find(path); it != image_cache.end()) {
+    evict(it);
+  }
+
+  while (cached_size + size > max_cached_size) {
+    auto lru = image_cache.begin();
+    for (auto it = image_cache.begin(); it != image_cache.end(); ++it) {
+      if (it->second.last_used < lru->second.last_used) {
+        lru = it;
+      }
+    }
+    evict(lru);
+  }
+
+  image_cache.emplace(std::string(path), cache_entry { .image = std::move(image), .file_size = info.file_size, .file_version = info.file_version, .last_used = ++use_count });
+  cached_size += size;
+}
@@ -12,11 +12,13 @@ void init() {
     abort();
   }
 
-  if (__heap_sbrk() == nullptr) [[unlikely]] {
+  size_t heap_size  = KILO_PAGE_SIZE;
+  void*  heap_start = __heap_sbrk(&heap_size);
+  if (heap_start == nullptr) [[unlikely]] {
     abort();
   }
 
-  __brk_start = __brk_pos - MEGA_PAGE_SIZE;
+  __brk_start = reinterpret_cast<uintptr_t>(heap_start);
   __heap_init();
 
   apm_ep_cap = mm_fetch_and_create_endpoint_object();
@@ -6,29 +6,59 @@
 #include <service/mm.h>
 #include <utility>
 
-program_loader::program_loader(std::reference_wrapper<task> target_ref, std::reference_wrapper<std::istream> stream_ref): target_ref(target_ref), stream_ref(stream_ref) { }
+namespace {
+  bool map_range(task& target, uintptr_t va, size_t size, int flags, size_t data_offset, std::string_view data) {
+    assert(va % KILO_PAGE_SIZE == 0);
+    assert(size % KILO_PAGE_SIZE == 0);
+    assert(data_offset + data.size() <= size);
 
-program_loader::~program_loader() { }
+    id_cap_t target_mm_id_cap = target.get_mm_id_cap().get();
 
-bool program_loader::map_page(uintptr_t va, int level, int flags, const void* data) {
-  assert(va % get_page_size(level) == 0);
+    if (data.empty()) {
+      return mm_vmap_range(target_mm_id_cap, get_max_page(), flags, va, size, 0, 0) != 0;
+    }
 
-  if (data != nullptr) {
-    uintptr_t addr = mm_vmap(__mm_id_cap, level, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, 0);
+    uintptr_t addr = mm_vmap_range(__mm_id_cap, KILO_PAGE, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, 0, size, 0, 0);
     if (addr == 0) [[unlikely]] {
       return false;
     }
-    memcpy(reinterpret_cast<void*>(addr), data, get_page_size(level));
-    addr = mm_vremap(__mm_id_cap, target_ref.get().get_mm_id_cap().get(), flags, addr, va);
-    if (addr == 0) [[unlikely]] {
+
+    char* ptr = reinterpret_cast<char*>(addr);
+
+    memset(ptr, 0, data_offset);
+    memcpy(ptr + data_offset, data.data(), data.size());
+    memset(ptr + data_offset + data.size(), 0, size - (data_offset + data.size()));
+
+    // The pages leave apm only when the request succeeds. Otherwise mm has put them back at the staging range.
+    if (mm_vmap_range(target_mm_id_cap, KILO_PAGE, flags, va, size, __mm_id_cap, addr) == 0) [[unlikely]] {
+      (void)mm_vunmap(__mm_id_cap, addr, size);
       return false;
     }
-  } else {
-    uintptr_t addr = mm_vmap(target_ref.get().get_mm_id_cap().get(), level, flags, va);
-    if (addr == 0) [[unlikely]] {
+
+    return true;
+  }
+} // namespace
+
+size_t program_image::data_size() const noexcept {
+  size_t size = 0;
+  for (const auto& segment : segments) {
+    size += segment.data.size();
+  }
+  return size;
+}
+
+program_loader::program_loader(std::reference_wrapper<std::istream> stream_ref): stream_ref(stream_ref) { }
+
+program_loader::~program_loader() { }
+
+bool map_program_image(task& target, const program_image& image) {
+  for (const auto& segment : image.segments) {
+    if (!map_range(target, segment.va, segment.size, segment.flags, segment.data_offset, segment.data)) [[unlikely]] {
       return false;
     }
   }
 
+  target.set_register(REG_PROGRAM_COUNTER, image.entry);
+
   return true;
 }
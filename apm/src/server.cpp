@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <apm/elf_loader.h>
+#include <apm/image_cache.h>
 #include <apm/ipc.h>
 #include <apm/server.h>
 #include <apm/task_manager.h>
@@ -40,6 +43,43 @@ namespace {
     return name;
   }
 
+  std::shared_ptr<const program_image> load_image(std::string_view path, fs_file_info& info) {
+    id_cap_t fd = fs_open_info(path.data(), &info);
+    if (fd == 0) [[unlikely]] {
+      return nullptr;
+    }
+
+    std::string data;
+    {
+      std::unique_ptr<char[]> buf = std::make_unique<char[]>(FS_READ_MAX_SIZE);
+      while (true) {
+        ssize_t read_size = fs_read(fd, buf.get(), FS_READ_MAX_SIZE);
+        if (read_size < 0) [[unlikely]] {
+          fs_close(fd);
+          return nullptr;
+        }
+        if (read_size == 0) [[unlikely]] {
+          break;
+        }
+        data.append(buf.get(), read_size);
+        if (read_size < FS_READ_MAX_SIZE) [[unlikely]] {
+          break;
+        }
+      }
+    }
+
+    fs_close(fd);
+
+    std::istringstream             stream(std::move(data), std::ios_base::binary);
+    elf_loader                     loader(std::ref<std::istream>(stream));
+    std::shared_ptr<program_image> image = std::make_shared<program_image>();
+    if (!loader.load(*image)) [[unlikely]] {
+      return nullptr;
+    }
+
+    return image;
+  }
+
   void create(message_t* msg) {
     assert(get_ipc_data(msg, 0) == APM_MSG_TYPE_CREATE);
 
@@ -70,32 +110,26 @@ namespace {
       __fs_ep_cap         = fs_task.get_ep_cap().get();
     }
 
-    id_cap_t fd = fs_open(path.data());
-
-    if (fd == 0) [[unlikely]] {
+    fs_file_info info;
+    if (!fs_info(path.data(), &info) || info.file_type != FS_FT_REG) [[unlikely]] {
       destroy_ipc_message(msg);
       set_ipc_data(msg, 0, APM_CODE_E_NO_SUCH_FILE);
       return;
     }
 
-    // TODO: fstream
-    std::string data;
-    {
-      std::unique_ptr<char[]> buf = std::make_unique<char[]>(0x1000);
-      while (true) {
-        size_t read_size = fs_read(fd, buf.get(), 0x1000);
-        if (read_size == static_cast<size_t>(-1)) [[unlikely]] {
-          destroy_ipc_message(msg);
-          set_ipc_data(msg, 0, APM_CODE_E_FAILURE);
-          return;
-        }
-        if (read_size == 0) [[unlikely]] {
-          break;
-        }
-        data.append(buf.get(), read_size);
-        if (read_size < 0x1000) [[unlikely]] {
-          break;
-        }
+    std::shared_ptr<const program_image> image = lookup_image(path, info);
+    if (!image) {
+      image = load_image(path, info);
+      if (!image) [[unlikely]] {
+        destroy_ipc_message(msg);
+        set_ipc_data(msg, 0, APM_CODE_E_FAILURE);
+        return;
+      }
+
+      // The file may have been rewritten while it was read, so the image is cached only if it is still the one opened.
+      fs_file_info current_info;
+      if (fs_info(path.data(), &current_info) && current_info.file_size == info.file_size && current_info.file_version == info.file_version) {
+        cache_image(path, info, image);
       }
     }
 
@@ -105,8 +139,7 @@ namespace {
       name          = rand_name_buf;
     }
 
-    std::istringstream stream(data, std::ios_base::binary);
-    if (!create_task(name, std::ref<std::istream>(stream), flags, msg->header.sender_id, args)) [[unlikely]] {
+    if (!create_task(name, *image, flags, msg->header.sender_id, args)) [[unlikely]] {
       destroy_ipc_message(msg);
       set_ipc_data(msg, 0, APM_CODE_E_FAILURE);
       return;
@@ -273,6 +306,45 @@ namespace {
     set_ipc_data_array(msg, 2, value.c_str(), value.size() + 1);
   }
 
+  void dumpenv(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == APM_MSG_TYPE_DUMPENV);
+
+    task_cap_t task_cap = get_ipc_cap(msg, 1);
+
+    if (unwrap_sysret(sys_cap_type(task_cap)) != CAP_TASK) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, APM_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    size_t offset    = get_ipc_data(msg, 2);
+    size_t max_chunk = get_ipc_data(msg, 3);
+
+    uint32_t tid = unwrap_sysret(sys_task_cap_tid(task_cap));
+
+    if (!task_exists(tid)) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, APM_CODE_E_NO_SUCH_TASK);
+      return;
+    }
+
+    const std::string& packed_env = lookup_task(tid).get_packed_env();
+
+    if (offset > packed_env.size()) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, APM_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    size_t chunk = std::min({ packed_env.size() - offset, max_chunk, msg->header.payload_capacity - sizeof(uintptr_t) * 3 });
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, APM_CODE_S_OK);
+    set_ipc_data(msg, 1, packed_env.size());
+    set_ipc_data(msg, 2, chunk);
+    set_ipc_data_array(msg, 3, packed_env.data() + offset, chunk);
+  }
+
   // clang-format off
 
   constexpr void (*const table[])(message_t*) = {
@@ -283,6 +355,7 @@ namespace {
     [APM_MSG_TYPE_SETENV]  = setenv,
     [APM_MSG_TYPE_GETENV]  = getenv,
     [APM_MSG_TYPE_NEXTENV] = nextenv,
+    [APM_MSG_TYPE_DUMPENV] = dumpenv,
   };
 
   // clang-format on
@@ -296,7 +369,7 @@ namespace {
 
     uintptr_t msg_type = get_ipc_data(msg, 0);
 
-    if (msg_type < APM_MSG_TYPE_CREATE || msg_type > APM_MSG_TYPE_NEXTENV) [[unlikely]] {
+    if (msg_type < APM_MSG_TYPE_CREATE || msg_type > APM_MSG_TYPE_DUMPENV) [[unlikely]] {
       destroy_ipc_message(msg);
       set_ipc_data(msg, 0, APM_CODE_E_ILL_ARGS);
     } else {
@@ -1,4 +1,3 @@
-#include <apm/elf_loader.h>
 #include <apm/ipc.h>
 #include <apm/server.h>
 #include <apm/task_manager.h>
@@ -40,45 +39,62 @@ task::task(std::string_view name, uint32_t parent_tid, const std::vector<std::st
 
   tid = unwrap_sysret(sys_task_cap_tid(task_cap.get()));
 
+  if (parent_tid != 0 && task_exists(parent_tid)) {
+    task& parent_task = lookup_task(parent_tid);
+    this->env         = parent_task.env;
+  }
+
+  // The stack starts with the argv index, the NULL-terminated envp index, the argv strings and the packed environment.
   size_t argv_len = 0;
   for (const auto& arg : args) {
     argv_len += arg.size() + 1;
   }
 
+  size_t             env_count  = get_env_count();
+  const std::string& packed_env = get_packed_env();
+
   size_t    argv_index_len  = sizeof(char*) * args.size();
-  size_t    argv_total_len  = (argv_len + sizeof(char*) - 1) / sizeof(char*) * sizeof(char*) + argv_index_len;
+  size_t    envp_index_len  = sizeof(char*) * (env_count + 1);
+  size_t    index_len       = argv_index_len + envp_index_len;
+  size_t    stack_data_len  = (argv_len + packed_env.size() + sizeof(char*) - 1) / sizeof(char*) * sizeof(char*) + index_len;
   uintptr_t user_space_end  = unwrap_sysret(sys_system_user_space_end());
-  uintptr_t argv_index_root = user_space_end - argv_total_len;
-  uintptr_t argv_root       = argv_index_root + argv_index_len;
+  uintptr_t argv_index_root = user_space_end - stack_data_len;
+  uintptr_t envp_index_root = argv_index_root + argv_index_len;
+  uintptr_t data_root       = argv_index_root + index_len;
 
-  std::unique_ptr<char[]> stack_data      = std::make_unique<char[]>(argv_total_len);
-  char*                   argv_data       = stack_data.get() + argv_index_len;
+  std::unique_ptr<char[]> stack_data      = std::make_unique<char[]>(stack_data_len);
+  char*                   data            = stack_data.get() + index_len;
   char**                  argv_index_data = reinterpret_cast<char**>(stack_data.get());
+  char**                  envp_index_data = reinterpret_cast<char**>(stack_data.get() + argv_index_len);
   size_t                  pos             = 0;
   for (size_t i = 0; i < args.size(); ++i) {
     const std::string_view& arg = args[i];
 
-    char* ptr = argv_data + pos;
+    char* ptr = data + pos;
     memcpy(ptr, arg.data(), arg.size());
     ptr[arg.size()] = '\0';
 
-    argv_index_data[i] = reinterpret_cast<char*>(argv_root + pos);
+    argv_index_data[i] = reinterpret_cast<char*>(data_root + pos);
 
     pos += arg.size() + 1;
   }
 
-  size_t stack_commit = std::max<size_t>(4 * KILO_PAGE_SIZE, (argv_len + KILO_PAGE_SIZE - 1) / KILO_PAGE_SIZE * KILO_PAGE_SIZE);
-  mm_id_cap           = mm_attach(task_cap.get(), root_page_table_cap.get(), 0, 0, stack_commit, stack_data.get(), argv_total_len);
+  memcpy(data + pos, packed_env.data(), packed_env.size());
+  for (size_t i = 0; i < env_count; ++i) {
+    envp_index_data[i] = reinterpret_cast<char*>(data_root + pos);
+
+    pos += strlen(data + pos) + 1;
+  }
+  envp_index_data[env_count] = nullptr;
+
+  size_t stack_commit = std::max<size_t>(4 * KILO_PAGE_SIZE, (stack_data_len + KILO_PAGE_SIZE - 1) / KILO_PAGE_SIZE * KILO_PAGE_SIZE);
+  mm_id_cap           = mm_attach(task_cap.get(), root_page_table_cap.get(), 0, 0, stack_commit, stack_data.get(), stack_data_len);
 
   sys_task_cap_set_reg(task_cap.get(), REG_ARG_0, args.size());
   sys_task_cap_set_reg(task_cap.get(), REG_ARG_1, argv_index_root);
+  sys_task_cap_set_reg(task_cap.get(), REG_ARG_7, envp_index_root);
 
   ep_cap = mm_fetch_and_create_endpoint_object();
-
-  if (parent_tid != 0 && task_exists(parent_tid)) {
-    task& parent_task = lookup_task(parent_tid);
-    this->env         = parent_task.env;
-  }
 }
 
 task::task(std::string_view name, task_cap_t task_cap, endpoint_cap_t ep_cap) noexcept: task_cap(task_cap), ep_cap(ep_cap), name(name), tid(0) {
@@ -147,35 +163,48 @@ bool task::set_env(std::string_view env, std::string_view value) noexcept {
     return false;
   }
 
-  this->env.insert_or_assign(std::string(env), value);
+  if (!this->env) {
+    this->env = std::make_shared<env_snapshot>();
+  } else if (this->env.use_count() > 1) {
+    this->env = std::make_shared<env_snapshot>(env_snapshot { .vars = this->env->vars, .packed = {} });
+  } else {
+    this->env->packed.clear();
+  }
+
+  this->env->vars.insert_or_assign(std::string(env), value);
 
   return true;
 }
 
 bool task::get_env(std::string_view env, std::string& value) const noexcept {
-  if (env.empty()) {
+  if (env.empty() || !this->env) {
     return false;
   }
 
-  if (!this->env.contains(env)) {
+  auto iter = this->env->vars.find(env);
+  if (iter == this->env->vars.end()) {
     return false;
   }
 
-  value = this->env.find(env)->second;
+  value = iter->second;
 
   return true;
 }
 
 bool task::next_env(std::string_view env, std::string& value) const noexcept {
-  auto iter = this->env.end();
+  if (!this->env) {
+    return false;
+  }
+
+  auto iter = this->env->vars.end();
 
   if (env.empty()) {
-    iter = this->env.begin();
+    iter = this->env->vars.begin();
   } else {
-    iter = this->env.upper_bound(env);
+    iter = this->env->vars.upper_bound(env);
   }
 
-  if (iter == this->env.end()) {
+  if (iter == this->env->vars.end()) {
     return false;
   }
 
@@ -184,6 +213,26 @@ bool task::next_env(std::string_view env, std::string& value) const noexcept {
   return true;
 }
 
+size_t task::get_env_count() const noexcept {
+  return this->env ? this->env->vars.size() : 0;
+}
+
+const std::string& task::get_packed_env() const noexcept {
+  static const std::string empty;
+
+  if (!this->env) {
+    return empty;
+  }
+
+  if (this->env->packed.empty()) {
+    for (const auto& [key, value] : this->env->vars) {
+      this->env->packed.append(key).append(1, '=').append(value).append(1, '\0');
+    }
+  }
+
+  return this->env->packed;
+}
+
 void task::set_register(uintptr_t reg, uintptr_t value) noexcept {
   sys_task_cap_set_reg(task_cap.get(), reg, value);
 }
@@ -196,14 +245,12 @@ cap_t task::transfer_cap(cap_t cap) const noexcept {
   return unwrap_sysret(sys_task_cap_transfer_cap(task_cap.get(), cap));
 }
 
-bool task::load_program(std::reference_wrapper<std::istream> data) {
+bool task::load_program(const program_image& image) {
   if (!task_cap) [[unlikely]] {
     return false;
   }
 
-  elf_loader loader(std::ref(*this), data);
-
-  return loader.load();
+  return map_program_image(*this, image);
 }
 
 void task::kill() const {
@@ -222,7 +269,7 @@ void task::suspend() const {
   sys_task_cap_suspend(task_cap.get());
 }
 
-bool create_task(std::string_view name, std::reference_wrapper<std::istream> data, int flags, uint32_t parent_tid, const std::vector<std::string_view>& args) {
+bool create_task(std::string_view name, const program_image& image, int flags, uint32_t parent_tid, const std::vector<std::string_view>& args) {
   if (task_table.contains(name)) [[unlikely]] {
     return false;
   }
@@ -233,7 +280,7 @@ bool create_task(std::string_view name, std::reference_wrapper<std::istream> dat
 
   task task(name, parent_tid, args);
 
-  if (!task.load_program(data)) {
+  if (!task.load_program(image)) {
     return false;
   }
 
@@ -7,8 +7,9 @@
 #include <string_view>
 
 struct console_ops {
-  void (*putc)(endpoint_cap_t ep_cap, char ch);
-  char (*getc)(endpoint_cap_t ep_cap);
+  void   (*putc)(endpoint_cap_t ep_cap, char ch);
+  size_t (*read)(endpoint_cap_t ep_cap, char* dst, size_t max_size);
+  void   (*write)(endpoint_cap_t ep_cap, std::string_view str);
 };
 
 enum struct console_mode {
@@ -20,6 +21,8 @@ class console {
   console_ops    ops;
   console_mode   mode;
   std::string    buffer;
+  std::string    input;
+  std::string    received;
   size_t         cursor_pos;
   endpoint_cap_t ep_cap;
   bool           esc;
@@ -30,14 +33,15 @@ public:
 
   ssize_t read(char* dst, size_t max_size);
   ssize_t write(std::string_view str);
+  bool    poll();
 
 private:
   char    getc();
   void    putc(char ch);
   void    puts(std::string_view str);
   void    move_cursor(std::streamoff offset);
-  ssize_t raw_read(char* dst, size_t max_size);
-  ssize_t cooked_read(char* dst, size_t max_size);
+  void    raw_poll();
+  void    cooked_poll();
 };
 
 #endif // CONS_CONSOLE_H_
@@ -10,7 +10,7 @@
 
 enum struct directory_type {
   regular_directory = FS_FT_DIR,
-  device_file       = FS_FT_REG,
+  device_file       = FS_FT_CHR,
 };
 
 class directory {
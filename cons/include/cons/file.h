@@ -27,6 +27,7 @@ public:
 
   [[nodiscard]] std::streamsize read(char* buffer, std::streamsize size);
   [[nodiscard]] std::streamsize write(std::string_view data);
+  [[nodiscard]] bool            poll();
 };
 
 #endif // CONS_FILE_H_
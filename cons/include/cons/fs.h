@@ -7,10 +7,14 @@
 
 [[nodiscard]] bool cons_init();
 
-[[nodiscard]] int cons_get_info(std::string_view path, fs_file_info& dst);
-[[nodiscard]] int cons_open(std::string_view path, id_cap_t& fd);
-[[nodiscard]] int cons_close(id_cap_t fd);
-[[nodiscard]] int cons_read(id_cap_t fd, char* buffer, std::streamsize size, std::streamsize& act_size);
-[[nodiscard]] int cons_write(id_cap_t fd, std::string_view data, std::streamsize& act_size);
+[[nodiscard]] int      cons_get_info(std::string_view path, fs_file_info& dst);
+[[nodiscard]] int      cons_open(std::string_view path, id_cap_t& fd, fs_file_info& info);
+[[nodiscard]] id_cap_t cons_open_channel(id_cap_t fd);
+[[nodiscard]] bool     cons_check_channel(id_cap_t fd, id_cap_t channel);
+[[nodiscard]] int      cons_close(id_cap_t fd);
+[[nodiscard]] int      cons_read(id_cap_t fd, char* buffer, std::streamsize size, std::streamsize& act_size, endpoint_cap_t& wait_ep);
+[[nodiscard]] int      cons_write(id_cap_t fd, std::string_view data, std::streamsize& act_size);
+[[nodiscard]] bool     cons_has_waiters();
+void                   cons_wake_waiters();
 
 #endif // CONS_FS_H_
@@ -2,8 +2,10 @@
 #define CONS_SUPPORT_UART_H_
 
 #include <libcaprese/cap.h>
+#include <string_view>
 
-void uart_putc(endpoint_cap_t ep_cap, char ch);
-char uart_getc(endpoint_cap_t ep_cap);
+void   uart_putc(endpoint_cap_t ep_cap, char ch);
+size_t uart_read(endpoint_cap_t ep_cap, char* dst, size_t max_size);
+void   uart_write(endpoint_cap_t ep_cap, std::string_view str);
 
 #endif // CONS_SUPPORT_UART_H_
@@ -1,17 +1,28 @@
+#include <algorithm>
 #include <cons/console.h>
 #include <cstring>
-#include <libcaprese/syscall.h>
 
 console::console(endpoint_cap_t ep_cap, console_ops ops, console_mode mode): ops(ops), mode(mode), cursor_pos(0), ep_cap(ep_cap), esc(false) { }
 
 ssize_t console::read(char* dst, size_t max_size) {
+  this->poll();
+
+  ssize_t result = static_cast<ssize_t>(this->input.copy(dst, max_size));
+  this->input.erase(0, result);
+
+  return result;
+}
+
+bool console::poll() {
   switch (this->mode) {
     case console_mode::raw:
-      return this->raw_read(dst, max_size);
+      this->raw_poll();
+      break;
     case console_mode::cooked:
-      return this->cooked_read(dst, max_size);
+      this->cooked_poll();
+      break;
   }
-  return 0;
+  return !this->input.empty();
 }
 
 ssize_t console::write(std::string_view str) {
@@ -19,16 +30,18 @@ ssize_t console::write(std::string_view str) {
     case console_mode::raw:
       this->puts(str);
       break;
-    case console_mode::cooked:
+    case console_mode::cooked: {
+      std::string output;
+      output.reserve(str.size() + std::count(str.begin(), str.end(), '\n'));
       for (const auto& ch : str) {
         if (ch == '\n') {
-          this->putc('\r');
-          this->putc('\n');
-        } else {
-          this->putc(ch);
+          output += '\r';
         }
+        output += ch;
       }
+      this->puts(output);
       break;
+    }
     default:
       return 0;
   }
@@ -36,13 +49,17 @@ ssize_t console::write(std::string_view str) {
 }
 
 char console::getc() {
-  char ch = this->ops.getc(this->ep_cap);
-
-  while (ch == static_cast<char>(-1)) {
-    sys_system_yield();
-    ch = this->ops.getc(this->ep_cap);
-  };
+  if (this->received.empty()) {
+    char   buf[64];
+    size_t n = this->ops.read(this->ep_cap, buf, sizeof(buf));
+    if (n == 0) {
+      return static_cast<char>(-1);
+    }
+    this->received.assign(buf, n);
+  }
 
+  char ch = this->received.front();
+  this->received.erase(0, 1);
   return ch;
 }
 
@@ -51,9 +68,7 @@ void console::putc(char ch) {
 }
 
 void console::puts(std::string_view str) {
-  for (const auto& ch : str) {
-    this->putc(ch);
-  }
+  this->ops.write(this->ep_cap, str);
 }
 
 void console::move_cursor(std::streamoff offset) {
@@ -82,10 +97,8 @@ void console::move_cursor(std::streamoff offset) {
   }
 }
 
-ssize_t console::raw_read(char* dst, size_t max_size) {
-  for (size_t i = 0; i < max_size; ++i) {
-    char ch = this->getc();
-
+void console::raw_poll() {
+  for (char ch = this->getc(); ch != static_cast<char>(-1); ch = this->getc()) {
     // CR/LF
     if (ch == '\r' || ch == '\n') {
       this->puts("\r\n");
@@ -93,17 +106,19 @@ ssize_t console::raw_read(char* dst, size_t max_size) {
       this->putc(ch);
     }
 
-    dst[i] = ch;
+    this->input += ch;
   }
-
-  return max_size;
 }
 
-ssize_t console::cooked_read(char* dst, size_t max_size) {
-  if (this->buffer.empty()) [[unlikely]] {
+void console::cooked_poll() {
+  if (this->input.empty()) [[unlikely]] {
     char ch;
     do {
       ch = this->getc();
+      if (ch == static_cast<char>(-1)) {
+        // The line is not complete yet; keep what has been typed so far for the next poll.
+        return;
+      }
 
       if (!this->esc) {
         switch (ch) {
@@ -140,6 +155,8 @@ ssize_t console::cooked_read(char* dst, size_t max_size) {
           case '\n': {
             this->puts("\r\n");
             this->buffer += '\n';
+            this->input += this->buffer;
+            this->buffer.clear();
             this->cursor_pos = 0;
             break;
           }
@@ -201,9 +218,4 @@ ssize_t console::cooked_read(char* dst, size_t max_size) {
       }
     } while (ch != '\n' && ch != '\r');
   }
-
-  ssize_t result = static_cast<ssize_t>(this->buffer.copy(dst, max_size));
-  this->buffer.erase(0, result);
-
-  return result;
 }
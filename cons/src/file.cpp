@@ -10,8 +10,9 @@ file::file(std::string_view abs_path, file_type type, endpoint_cap_t ep_cap): ab
   console_ops ops;
   switch (type) {
     case file_type::uart:
-      ops.putc = uart_putc;
-      ops.getc = uart_getc;
+      ops.putc  = uart_putc;
+      ops.read  = uart_read;
+      ops.write = uart_write;
       break;
     default:
       return;
@@ -39,3 +40,11 @@ std::streamsize file::write(std::string_view data) {
 
   return this->console->write(data);
 }
+
+bool file::poll() {
+  if (!this->console.has_value()) [[unlikely]] {
+    return false;
+  }
+
+  return this->console->poll();
+}
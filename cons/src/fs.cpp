@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cons/directory.h>
 #include <cons/file.h>
 #include <cons/fs.h>
@@ -8,10 +9,18 @@
 #include <optional>
 #include <service/apm.h>
 #include <service/fs.h>
+#include <service/mm.h>
+#include <vector>
 
 namespace {
   std::optional<directory>                      root_directory;
   caprese::id_map<std::reference_wrapper<file>> open_files;
+  caprese::id_map<id_cap_t>                     channels;
+
+  // A reader told to wait receives on wait_ep_cap, and is let go with a send once one of the waiting files has input.
+  endpoint_cap_t                            wait_ep_cap;
+  std::vector<std::reference_wrapper<file>> waiting_files;
+  size_t                                    num_waiters;
 
   std::optional<std::reference_wrapper<directory>> create_directories(std::string_view path) {
     if (path.empty() || path[0] == '/') [[unlikely]] {
@@ -84,6 +93,14 @@ namespace {
 
     return cur;
   }
+
+  void get_info(directory& dir, fs_file_info& dst) {
+    dst.file_type      = static_cast<uint8_t>(dir.get_type());
+    dst.file_name_size = dir.get_name().size();
+    dst.file_size      = 0;
+    dst.file_version   = 0;
+    std::copy(dir.get_name().begin(), dir.get_name().end(), dst.file_name);
+  }
 } // namespace
 
 bool cons_init() {
@@ -100,6 +117,11 @@ bool cons_init() {
 
   directory& dir = result->get();
 
+  wait_ep_cap = mm_fetch_and_create_endpoint_object();
+  if (wait_ep_cap == 0) [[unlikely]] {
+    return false;
+  }
+
   endpoint_cap_t uart_ep_cap = apm_lookup("uart");
   if (uart_ep_cap == 0) [[unlikely]] {
     return false;
@@ -125,17 +147,12 @@ int cons_get_info(std::string_view path, fs_file_info& dst) {
     return FS_CODE_E_NO_SUCH_FILE;
   }
 
-  directory& dir = result->get();
-
-  dst.file_type      = static_cast<uint8_t>(dir.get_type());
-  dst.file_name_size = dir.get_name().size();
-  dst.file_size      = 0;
-  std::copy(dir.get_name().begin(), dir.get_name().end(), dst.file_name);
+  get_info(result->get(), dst);
 
   return FS_CODE_S_OK;
 }
 
-int cons_open(std::string_view path, id_cap_t& fd) {
+int cons_open(std::string_view path, id_cap_t& fd, fs_file_info& info) {
   auto result = find_directory(path);
   if (!result) [[unlikely]] {
     return FS_CODE_E_NO_SUCH_FILE;
@@ -149,9 +166,21 @@ int cons_open(std::string_view path, id_cap_t& fd) {
   fd = unwrap_sysret(sys_id_cap_create());
   open_files.emplace(fd, dir.get_file());
 
+  get_info(dir, info);
+
   return FS_CODE_S_OK;
 }
 
+id_cap_t cons_open_channel(id_cap_t fd) {
+  id_cap_t channel = unwrap_sysret(sys_id_cap_create());
+  channels.emplace(fd, channel);
+  return channel;
+}
+
+bool cons_check_channel(id_cap_t fd, id_cap_t channel) {
+  return channels.contains(fd) && unwrap_sysret(sys_id_cap_compare(channels.at(fd), channel)) == 0;
+}
+
 int cons_close(id_cap_t fd) {
   if (!open_files.contains(fd)) [[unlikely]] {
     return FS_CODE_E_NO_SUCH_FILE;
@@ -159,19 +188,72 @@ int cons_close(id_cap_t fd) {
 
   open_files.erase(fd);
 
+  if (channels.contains(fd)) {
+    sys_cap_destroy(channels.at(fd));
+    channels.erase(fd);
+  }
+
   return FS_CODE_S_OK;
 }
 
-int cons_read(id_cap_t fd, char* buffer, std::streamsize size, std::streamsize& act_size) {
+int cons_read(id_cap_t fd, char* buffer, std::streamsize size, std::streamsize& act_size, endpoint_cap_t& wait_ep) {
   if (!open_files.contains(fd)) [[unlikely]] {
     return FS_CODE_E_NO_SUCH_FILE;
   }
 
-  act_size = open_files.at(fd).get().read(buffer, size);
+  file& f  = open_files.at(fd).get();
+  act_size = f.read(buffer, size);
+
+  if (act_size < 0) [[unlikely]] {
+    return FS_CODE_E_FAILURE;
+  }
+
+  // Nothing has been typed yet. Park the caller on the wait endpoint instead of holding up the whole server.
+  if (act_size == 0 && size > 0) {
+    wait_ep = unwrap_sysret(sys_endpoint_cap_copy(wait_ep_cap));
+    if (std::none_of(waiting_files.begin(), waiting_files.end(), [&f](const file& waiting) { return &waiting == &f; })) {
+      waiting_files.push_back(f);
+    }
+    ++num_waiters;
+    return FS_CODE_E_AGAIN;
+  }
 
   return FS_CODE_S_OK;
 }
 
+bool cons_has_waiters() {
+  return num_waiters > 0;
+}
+
+void cons_wake_waiters() {
+  bool ready = false;
+  for (file& f : waiting_files) {
+    ready = f.poll() || ready;
+  }
+
+  if (!ready) {
+    return;
+  }
+
+  char       msg_buf[sizeof(message_header) + sizeof(uintptr_t)];
+  message_t* msg               = reinterpret_cast<message_t*>(msg_buf);
+  msg->header.payload_length   = 0;
+  msg->header.payload_capacity = sizeof(msg_buf) - sizeof(message_header);
+
+  // A send fails while the reader has not reached its receive yet. Such a reader stays counted and is let go on a later poll.
+  while (num_waiters > 0) {
+    set_ipc_data(msg, 0, FS_CODE_S_OK);
+    if (sysret_failed(sys_endpoint_cap_nb_send_long(wait_ep_cap, msg))) {
+      break;
+    }
+    --num_waiters;
+  }
+
+  if (num_waiters == 0) {
+    waiting_files.clear();
+  }
+}
+
 int cons_write(id_cap_t fd, std::string_view data, std::streamsize& act_size) {
   if (!open_files.contains(fd)) [[unlikely]] {
     return FS_CODE_E_NO_SUCH_FILE;
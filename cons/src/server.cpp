@@ -44,8 +44,9 @@ namespace {
       return;
     }
 
-    id_cap_t fd;
-    int      result = cons_open(c_path, fd);
+    id_cap_t     fd;
+    fs_file_info info;
+    int          result = cons_open(c_path, fd, info);
 
     destroy_ipc_message(msg);
     set_ipc_data(msg, 0, result);
@@ -54,7 +55,11 @@ namespace {
       return;
     }
 
+    id_cap_t channel = cons_open_channel(fd);
+
     set_ipc_cap(msg, 1, unwrap_sysret(sys_id_cap_copy(fd)), false);
+    set_ipc_cap(msg, 2, unwrap_sysret(sys_id_cap_copy(channel)), false);
+    set_ipc_data_array(msg, 3, &info, sizeof(info));
   }
 
   void close(message_t* msg) {
@@ -92,11 +97,17 @@ namespace {
 
     std::unique_ptr<char[]> buffer = std::make_unique<char[]>(len);
     std::streamsize         act_size;
-    int                     result = cons_read(fd, buffer.get(), len, act_size);
+    endpoint_cap_t          wait_ep = 0;
+    int                     result  = cons_read(fd, buffer.get(), len, act_size, wait_ep);
 
     destroy_ipc_message(msg);
     set_ipc_data(msg, 0, result);
 
+    if (result == FS_CODE_E_AGAIN) {
+      set_ipc_cap(msg, 1, wait_ep, false);
+      return;
+    }
+
     if (result != FS_CODE_S_OK && result != FS_CODE_E_EOF) [[unlikely]] {
       return;
     }
@@ -143,37 +154,61 @@ namespace {
   }
 
   constexpr void (*const table[])(message_t*) = {
-    [0]                   = nullptr,
-    [FS_MSG_TYPE_MOUNT]   = nullptr,
-    [FS_MSG_TYPE_UNMOUNT] = nullptr,
-    [FS_MSG_TYPE_MOUNTED] = nullptr,
-    [FS_MSG_TYPE_INFO]    = info,
-    [FS_MSG_TYPE_CREATE]  = nullptr,
-    [FS_MSG_TYPE_REMOVE]  = nullptr,
-    [FS_MSG_TYPE_OPEN]    = open,
-    [FS_MSG_TYPE_CLOSE]   = close,
-    [FS_MSG_TYPE_READ]    = read,
-    [FS_MSG_TYPE_WRITE]   = write,
-    [FS_MSG_TYPE_SEEK]    = nullptr,
-    [FS_MSG_TYPE_TELL]    = nullptr,
+    [0]                    = nullptr,
+    [FS_MSG_TYPE_MOUNT]    = nullptr,
+    [FS_MSG_TYPE_UNMOUNT]  = nullptr,
+    [FS_MSG_TYPE_MOUNTED]  = nullptr,
+    [FS_MSG_TYPE_INFO]     = info,
+    [FS_MSG_TYPE_CREATE]   = nullptr,
+    [FS_MSG_TYPE_REMOVE]   = nullptr,
+    [FS_MSG_TYPE_OPEN]     = open,
+    [FS_MSG_TYPE_CLOSE]    = close,
+    [FS_MSG_TYPE_READ]     = read,
+    [FS_MSG_TYPE_WRITE]    = write,
+    [FS_MSG_TYPE_SEEK]     = nullptr,
+    [FS_MSG_TYPE_TELL]     = nullptr,
+    [FS_MSG_TYPE_MMAP]     = nullptr,
+    [FS_MSG_TYPE_TRUNCATE] = nullptr,
+    [FS_MSG_TYPE_READDIR]  = nullptr,
+    [FS_MSG_TYPE_PREAD]    = nullptr,
+    [FS_MSG_TYPE_PWRITE]   = nullptr,
+    [FS_MSG_TYPE_PREADV]   = nullptr,
+    [FS_MSG_TYPE_PWRITEV]  = nullptr,
+    [FS_MSG_TYPE_READFILE] = nullptr,
   };
 
-  void proc_msg(message_t* msg) {
+  // The fs server presents cons_id_cap. A redirected client presents the channel id of its fd instead.
+  bool is_permitted(message_t* msg, uintptr_t msg_type) {
     id_cap_t id = get_ipc_cap(msg, 1);
     if (unwrap_sysret(sys_cap_type(id)) != CAP_ID) [[unlikely]] {
-      destroy_ipc_message(msg);
-      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
-      return;
+      return false;
+    }
+
+    if (unwrap_sysret(sys_id_cap_compare(id, cons_id_cap)) == 0) {
+      return true;
+    }
+
+    if (!FS_IS_CHANNEL_MSG_TYPE(msg_type)) [[unlikely]] {
+      return false;
     }
 
-    if (unwrap_sysret(sys_id_cap_compare(id, cons_id_cap)) != 0) [[unlikely]] {
+    id_cap_t fd = get_ipc_cap(msg, 2);
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      return false;
+    }
+
+    return cons_check_channel(fd, id);
+  }
+
+  void proc_msg(message_t* msg) {
+    uintptr_t msg_type = get_ipc_data(msg, 0);
+
+    if (!is_permitted(msg, msg_type)) [[unlikely]] {
       destroy_ipc_message(msg);
       set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
       return;
     }
 
-    uintptr_t msg_type = get_ipc_data(msg, 0);
-
     if (msg_type >= std::size(table)) [[unlikely]] {
       destroy_ipc_message(msg);
       set_ipc_data(msg, 0, FS_CODE_E_UNSUPPORTED);
@@ -201,7 +236,20 @@ namespace {
       unwrap_sysret(sys_task_cap_insert_cap_space(__this_task_cap, cap_space_cap));
     }
 
-    if (sysret_succeeded(sysret)) {
+    // Nothing reports incoming input while a reader is parked, so requests are taken without blocking and input is
+    // checked in between.
+    if (cons_has_waiters()) {
+      if (sysret_succeeded(sysret)) {
+        sys_endpoint_cap_reply(__this_ep_cap, msg);
+      }
+
+      sysret = sys_endpoint_cap_nb_receive(__this_ep_cap, msg);
+      if (sysret_failed(sysret)) {
+        cons_wake_waiters();
+        sys_system_yield();
+        continue;
+      }
+    } else if (sysret_succeeded(sysret)) {
       sysret = sys_endpoint_cap_reply_and_receive(__this_ep_cap, msg);
     } else {
       sysret = sys_endpoint_cap_receive(__this_ep_cap, msg);
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cons/support/uart.h>
+#include <cstring>
 #include <libcaprese/syscall.h>
 #include <uart/ipc.h>
 
@@ -14,19 +16,58 @@ void uart_putc(endpoint_cap_t ep_cap, char ch) {
   sys_endpoint_cap_call(ep_cap, msg);
 }
 
-char uart_getc(endpoint_cap_t ep_cap) {
-  char       msg_buf[sizeof(message_t) + sizeof(uintptr_t) * 2];
+// Fetches whatever the driver has received so far without waiting for more, so that cons keeps serving other requests.
+size_t uart_read(endpoint_cap_t ep_cap, char* dst, size_t max_size) {
+  char       msg_buf[sizeof(message_t) + UART_MSG_CAPACITY];
   message_t* msg               = reinterpret_cast<message_t*>(msg_buf);
   msg->header.payload_length   = 0;
-  msg->header.payload_capacity = sizeof(uintptr_t) * 2;
+  msg->header.payload_capacity = UART_MSG_CAPACITY;
 
-  set_ipc_data(msg, 0, UART_MSG_TYPE_GETC);
+  max_size = std::min<size_t>(max_size, UART_READ_MAX_SIZE);
 
-  sys_endpoint_cap_call(ep_cap, msg);
+  set_ipc_data(msg, 0, UART_MSG_TYPE_READ);
+  set_ipc_data(msg, 1, max_size);
+  set_ipc_data(msg, 2, 0);
+
+  sysret_t sysret = sys_endpoint_cap_call(ep_cap, msg);
+  if (sysret_failed(sysret) || get_ipc_data(msg, 0) != UART_CODE_S_OK) [[unlikely]] {
+    return 0;
+  }
+
+  size_t size = std::min<size_t>(get_ipc_data(msg, 1), max_size);
+  if (size == 0) {
+    return 0;
+  }
 
-  if (get_ipc_data(msg, 0) != UART_CODE_S_OK) {
-    return static_cast<char>(-1);
+  const void* data = get_ipc_data_ptr(msg, 2);
+  if (data == nullptr) [[unlikely]] {
+    return 0;
   }
 
-  return static_cast<char>(get_ipc_data(msg, 1));
+  memcpy(dst, data, size);
+
+  return size;
+}
+
+void uart_write(endpoint_cap_t ep_cap, std::string_view str) {
+  char       msg_buf[sizeof(message_t) + UART_MSG_CAPACITY];
+  message_t* msg = reinterpret_cast<message_t*>(msg_buf);
+
+  while (!str.empty()) {
+    size_t size = std::min<size_t>(str.size(), UART_WRITE_MAX_SIZE);
+
+    msg->header.payload_length   = 0;
+    msg->header.payload_capacity = UART_MSG_CAPACITY;
+
+    set_ipc_data(msg, 0, UART_MSG_TYPE_WRITE);
+    set_ipc_data(msg, 1, size);
+    set_ipc_data_array(msg, 2, str.data(), size);
+
+    sysret_t sysret = sys_endpoint_cap_call(ep_cap, msg);
+    if (sysret_failed(sysret) || get_ipc_data(msg, 0) != UART_CODE_S_OK) [[unlikely]] {
+      return;
+    }
+
+    str.remove_prefix(size);
+  }
 }
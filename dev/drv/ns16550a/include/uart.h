@@ -34,10 +34,17 @@
 #define UART_LSR_FIFOE          (1 << 8) // FIFO Error
 #define UART_LSR_BRK_ERROR_BITS (UART_LSR_OE | UART_LSR_PE | UART_LSR_FE | UART_LSR_BI)
 
+#define UART_FIFO_SIZE      16
+#define UART_RX_BUFFER_SIZE 256
+
+#include <stddef.h>
 #include <stdint.h>
 
-void init_uart(uintptr_t base_addr, uint32_t frequency, uint32_t baudrate, uint32_t reg_shift, uint32_t reg_width, uint32_t reg_offset);
-void uart_putc(int ch);
-int  uart_getc(void);
+void   init_uart(uintptr_t base_addr, uint32_t frequency, uint32_t baudrate, uint32_t reg_shift, uint32_t reg_width, uint32_t reg_offset);
+void   uart_putc(int ch);
+int    uart_getc(void);
+void   uart_write(const char* data, size_t size);
+size_t uart_read(char* dst, size_t size);
+void   uart_poll(void);
 
 #endif // DEV_NS16550A_UART_H_
@@ -32,10 +32,64 @@ static void proc_getc(message_t* msg) {
   set_ipc_data(msg, 1, (uintptr_t)((intptr_t)ch));
 }
 
+static void proc_write(message_t* msg) {
+  assert(msg != NULL);
+  assert(get_ipc_data(msg, 0) == UART_MSG_TYPE_WRITE);
+
+  size_t size = get_ipc_data(msg, 1);
+  __if_unlikely (size > UART_WRITE_MAX_SIZE) {
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, UART_CODE_E_ILL_ARGS);
+    return;
+  }
+
+  const char* data = get_ipc_data_ptr(msg, 2);
+  __if_unlikely (data == NULL && size > 0) {
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, UART_CODE_E_ILL_ARGS);
+    return;
+  }
+
+  uart_write(data, size);
+
+  destroy_ipc_message(msg);
+  set_ipc_data(msg, 0, UART_CODE_S_OK);
+  set_ipc_data(msg, 1, size);
+}
+
+static void proc_read(message_t* msg) {
+  assert(msg != NULL);
+  assert(get_ipc_data(msg, 0) == UART_MSG_TYPE_READ);
+
+  size_t max_size = get_ipc_data(msg, 1);
+  size_t min_size = get_ipc_data(msg, 2);
+  __if_unlikely (max_size > UART_READ_MAX_SIZE || min_size > max_size) {
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, UART_CODE_E_ILL_ARGS);
+    return;
+  }
+
+  char   buf[UART_READ_MAX_SIZE];
+  size_t size = uart_read(buf, max_size);
+
+  // There is no interrupt delivery to user space, so a blocking read keeps polling the line status here.
+  while (size < min_size) {
+    sys_system_yield();
+    size += uart_read(buf + size, max_size - size);
+  }
+
+  destroy_ipc_message(msg);
+  set_ipc_data(msg, 0, UART_CODE_S_OK);
+  set_ipc_data(msg, 1, size);
+  set_ipc_data_array(msg, 2, buf, size);
+}
+
 static void (*const table[])(message_t*) = {
-  [0]                  = NULL,
-  [UART_MSG_TYPE_PUTC] = proc_putc,
-  [UART_MSG_TYPE_GETC] = proc_getc,
+  [0]                   = NULL,
+  [UART_MSG_TYPE_PUTC]  = proc_putc,
+  [UART_MSG_TYPE_GETC]  = proc_getc,
+  [UART_MSG_TYPE_WRITE] = proc_write,
+  [UART_MSG_TYPE_READ]  = proc_read,
 };
 
 static void proc_msg(message_t* msg) {
@@ -43,17 +97,19 @@ static void proc_msg(message_t* msg) {
 
   uintptr_t msg_type = get_ipc_data(msg, 0);
 
-  __if_unlikely (msg_type < UART_MSG_TYPE_PUTC || msg_type > UART_MSG_TYPE_GETC) {
+  __if_unlikely (msg_type < UART_MSG_TYPE_PUTC || msg_type > UART_MSG_TYPE_READ) {
     destroy_ipc_message(msg);
     set_ipc_data(msg, 0, UART_CODE_E_ILL_ARGS);
     return;
   }
 
+  uart_poll();
+
   table[msg_type](msg);
 }
 
 noreturn void run() {
-  message_t* msg = new_ipc_message(sizeof(uintptr_t) * 2);
+  message_t* msg = new_ipc_message(UART_MSG_CAPACITY);
   sysret_t   sysret;
 
   sysret.error = SYS_E_UNKNOWN;
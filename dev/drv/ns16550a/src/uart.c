@@ -6,6 +6,11 @@ static uint32_t  uart_baud;
 static uint32_t  uart_shift;
 static uint32_t  uart_width;
 
+// Received bytes are moved out of the 16-byte RX FIFO on every request so that they are not lost to an overrun.
+static char   rx_buffer[UART_RX_BUFFER_SIZE];
+static size_t rx_head;
+static size_t rx_tail;
+
 static volatile uint8_t* get_reg(uintptr_t reg) {
   uint32_t offset = reg << uart_shift;
   return (uint8_t*)(uart_base_addr + offset);
@@ -93,9 +98,44 @@ void uart_putc(int ch) {
   write(UART_THR, ch);
 }
 
+// THRE means the whole transmit FIFO is empty, so it can take a full FIFO worth of bytes at once.
+// A long write takes far longer than the receive FIFO lasts, so input is drained while waiting.
+void uart_write(const char* data, size_t size) {
+  while (size > 0) {
+    while ((read(UART_LSR) & UART_LSR_THRE) == 0) {
+      uart_poll();
+    }
+
+    size_t n = size < UART_FIFO_SIZE ? size : UART_FIFO_SIZE;
+    for (size_t i = 0; i < n; ++i) {
+      write(UART_THR, data[i]);
+    }
+
+    data += n;
+    size -= n;
+  }
+}
+
 int uart_getc(void) {
-  if (read(UART_LSR) & UART_LSR_DR) {
-    return read(UART_RBR);
+  uart_poll();
+  if (rx_head == rx_tail) {
+    return -1;
+  }
+  return (unsigned char)rx_buffer[rx_head++ % UART_RX_BUFFER_SIZE];
+}
+
+size_t uart_read(char* dst, size_t size) {
+  uart_poll();
+
+  size_t n = 0;
+  while (n < size && rx_head != rx_tail) {
+    dst[n++] = rx_buffer[rx_head++ % UART_RX_BUFFER_SIZE];
+  }
+  return n;
+}
+
+void uart_poll(void) {
+  while (rx_tail - rx_head < UART_RX_BUFFER_SIZE && (read(UART_LSR) & UART_LSR_DR)) {
+    rx_buffer[rx_tail++ % UART_RX_BUFFER_SIZE] = read(UART_RBR);
   }
-  return -1;
 }
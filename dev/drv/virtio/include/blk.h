@@ -0,0 +1,26 @@
+#ifndef DEV_VIRTIO_BLK_H_
+#define DEV_VIRTIO_BLK_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct blk_segment {
+  uintptr_t phys_addr;
+  size_t    size;
+};
+
+struct blk_request {
+  int                 op;
+  uint64_t            sector;
+  size_t              num_segments;
+  struct blk_segment* segments;
+  int                 result;
+};
+
+bool     init_blk(uintptr_t base_addr);
+uint64_t blk_capacity(void);
+bool     blk_read_only(void);
+void     blk_submit(struct blk_request* requests, size_t num_requests);
+
+#endif // DEV_VIRTIO_BLK_H_
@@ -0,0 +1,8 @@
+#ifndef DEV_VIRTIO_SERVER_H_
+#define DEV_VIRTIO_SERVER_H_
+
+#include <stdnoreturn.h>
+
+noreturn void run(void);
+
+#endif // DEV_VIRTIO_SERVER_H_
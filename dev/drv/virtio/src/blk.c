@@ -0,0 +1,318 @@
+#include "blk.h"
+
+#include "virtio.h"
+
+#include <blk/ipc.h>
+#include <crt/global.h>
+#include <internal/branch.h>
+#include <libcaprese/syscall.h>
+#include <service/mm.h>
+#include <string.h>
+
+#define QUEUE_SIZE 64
+
+// The whole virtqueue and the request headers live in a single page.
+// The rings follow the legacy layout, which the modern interface can describe as well.
+#define QUEUE_USED_ALIGN    0x40
+#define QUEUE_HEADER_OFFSET 0x800
+#define QUEUE_STATUS_OFFSET 0xc00
+
+static uintptr_t mmio_base;
+static uint32_t  mmio_version;
+static uint64_t  capacity;
+static bool      read_only;
+
+static uintptr_t                     queue_phys_addr;
+static struct virtq_desc*            desc;
+static struct virtq_avail*           avail;
+static struct virtq_used*            used;
+static struct virtio_blk_req_header* headers;
+static volatile uint8_t*             statuses;
+static uint16_t                      queue_size;
+static uint16_t                      free_head;
+static uint16_t                      num_free;
+static uint16_t                      last_used_idx;
+
+// The client requests that were merged into the virtio request whose chain starts at the descriptor.
+static size_t inflight_first[QUEUE_SIZE];
+static size_t inflight_count[QUEUE_SIZE];
+
+static uint32_t read32(uintptr_t offset) {
+  uint32_t value = *(volatile uint32_t*)(mmio_base + offset);
+  __sync_synchronize();
+  return value;
+}
+
+static void write32(uintptr_t offset, uint32_t value) {
+  __sync_synchronize();
+  *(volatile uint32_t*)(mmio_base + offset) = value;
+}
+
+static bool init_queue(void) {
+  mem_cap_t mem_cap = mm_fetch(KILO_PAGE_SIZE, KILO_PAGE_SIZE);
+  __if_unlikely (mem_cap == 0) {
+    return false;
+  }
+
+  queue_phys_addr = unwrap_sysret(sys_mem_cap_phys_addr(mem_cap));
+
+  sysret_t sysret = sys_mem_cap_create_virt_page_object(mem_cap, true, true, false, KILO_PAGE);
+  __if_unlikely (sysret_failed(sysret)) {
+    return false;
+  }
+
+  uintptr_t va = mm_vpmap(__mm_id_cap, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, sysret.result, 0);
+  __if_unlikely (va == 0) {
+    return false;
+  }
+
+  memset((void*)va, 0, KILO_PAGE_SIZE);
+
+  write32(VIRTIO_MMIO_QUEUE_SEL, 0);
+
+  uint32_t num_max = read32(VIRTIO_MMIO_QUEUE_NUM_MAX);
+  __if_unlikely (num_max < BLK_MAX_REQUEST_SEGMENTS + 2) {
+    return false;
+  }
+
+  queue_size = num_max < QUEUE_SIZE ? num_max : QUEUE_SIZE;
+  write32(VIRTIO_MMIO_QUEUE_NUM, queue_size);
+
+  size_t avail_offset = sizeof(struct virtq_desc) * queue_size;
+  size_t used_offset  = (avail_offset + sizeof(uint16_t) * (3 + queue_size) + QUEUE_USED_ALIGN - 1) / QUEUE_USED_ALIGN * QUEUE_USED_ALIGN;
+
+  desc     = (struct virtq_desc*)va;
+  avail    = (struct virtq_avail*)(va + avail_offset);
+  used     = (struct virtq_used*)(va + used_offset);
+  headers  = (struct virtio_blk_req_header*)(va + QUEUE_HEADER_OFFSET);
+  statuses = (volatile uint8_t*)(va + QUEUE_STATUS_OFFSET);
+
+  // Completions are polled, so the device does not need to raise interrupts.
+  avail->flags = VIRTQ_AVAIL_F_NO_INTERRUPT;
+
+  for (uint16_t i = 0; i < queue_size; ++i) {
+    desc[i].next = i + 1;
+  }
+  free_head     = 0;
+  num_free      = queue_size;
+  last_used_idx = 0;
+
+  if (mmio_version == 1) {
+    write32(VIRTIO_MMIO_QUEUE_ALIGN, QUEUE_USED_ALIGN);
+    write32(VIRTIO_MMIO_QUEUE_PFN, queue_phys_addr / KILO_PAGE_SIZE);
+  } else {
+    uint64_t desc_addr  = queue_phys_addr;
+    uint64_t avail_addr = queue_phys_addr + avail_offset;
+    uint64_t used_addr  = queue_phys_addr + used_offset;
+    write32(VIRTIO_MMIO_QUEUE_DESC_LOW, (uint32_t)desc_addr);
+    write32(VIRTIO_MMIO_QUEUE_DESC_HIGH, (uint32_t)(desc_addr >> 32));
+    write32(VIRTIO_MMIO_QUEUE_DRIVER_LOW, (uint32_t)avail_addr);
+    write32(VIRTIO_MMIO_QUEUE_DRIVER_HIGH, (uint32_t)(avail_addr >> 32));
+    write32(VIRTIO_MMIO_QUEUE_DEVICE_LOW, (uint32_t)used_addr);
+    write32(VIRTIO_MMIO_QUEUE_DEVICE_HIGH, (uint32_t)(used_addr >> 32));
+    write32(VIRTIO_MMIO_QUEUE_READY, 1);
+  }
+
+  return true;
+}
+
+bool init_blk(uintptr_t base_addr) {
+  mmio_base = base_addr;
+
+  __if_unlikely (read32(VIRTIO_MMIO_MAGIC_VALUE) != VIRTIO_MMIO_MAGIC || read32(VIRTIO_MMIO_DEVICE_ID) != VIRTIO_DEVICE_ID_BLK) {
+    return false;
+  }
+
+  mmio_version = read32(VIRTIO_MMIO_VERSION);
+  __if_unlikely (mmio_version != 1 && mmio_version != 2) {
+    return false;
+  }
+
+  write32(VIRTIO_MMIO_STATUS, 0);
+  write32(VIRTIO_MMIO_STATUS, VIRTIO_STATUS_ACKNOWLEDGE);
+  write32(VIRTIO_MMIO_STATUS, VIRTIO_STATUS_ACKNOWLEDGE | VIRTIO_STATUS_DRIVER);
+
+  write32(VIRTIO_MMIO_DEVICE_FEATURES_SEL, 0);
+  uint32_t features = read32(VIRTIO_MMIO_DEVICE_FEATURES);
+  read_only         = (features & (1 << VIRTIO_BLK_F_RO)) != 0;
+
+  write32(VIRTIO_MMIO_DRIVER_FEATURES_SEL, 0);
+  write32(VIRTIO_MMIO_DRIVER_FEATURES, features & (1 << VIRTIO_BLK_F_RO));
+
+  uint32_t status = VIRTIO_STATUS_ACKNOWLEDGE | VIRTIO_STATUS_DRIVER;
+
+  if (mmio_version == 1) {
+    write32(VIRTIO_MMIO_GUEST_PAGE_SIZE, KILO_PAGE_SIZE);
+  } else {
+    write32(VIRTIO_MMIO_DEVICE_FEATURES_SEL, 1);
+    __if_unlikely ((read32(VIRTIO_MMIO_DEVICE_FEATURES) & (1 << (VIRTIO_F_VERSION_1 - 32))) == 0) {
+      write32(VIRTIO_MMIO_STATUS, VIRTIO_STATUS_FAILED);
+      return false;
+    }
+    write32(VIRTIO_MMIO_DRIVER_FEATURES_SEL, 1);
+    write32(VIRTIO_MMIO_DRIVER_FEATURES, 1 << (VIRTIO_F_VERSION_1 - 32));
+
+    status |= VIRTIO_STATUS_FEATURES_OK;
+    write32(VIRTIO_MMIO_STATUS, status);
+    __if_unlikely ((read32(VIRTIO_MMIO_STATUS) & VIRTIO_STATUS_FEATURES_OK) == 0) {
+      write32(VIRTIO_MMIO_STATUS, VIRTIO_STATUS_FAILED);
+      return false;
+    }
+  }
+
+  __if_unlikely (!init_queue()) {
+    write32(VIRTIO_MMIO_STATUS, VIRTIO_STATUS_FAILED);
+    return false;
+  }
+
+  capacity = (uint64_t)read32(VIRTIO_MMIO_CONFIG) | ((uint64_t)read32(VIRTIO_MMIO_CONFIG + 4) << 32);
+
+  write32(VIRTIO_MMIO_STATUS, status | VIRTIO_STATUS_DRIVER_OK);
+
+  return true;
+}
+
+uint64_t blk_capacity(void) {
+  return capacity;
+}
+
+bool blk_read_only(void) {
+  return read_only;
+}
+
+static size_t request_sectors(const struct blk_request* request) {
+  size_t size = 0;
+  for (size_t i = 0; i < request->num_segments; ++i) {
+    size += request->segments[i].size;
+  }
+  return size / BLK_SECTOR_SIZE;
+}
+
+static uint16_t alloc_desc(void) {
+  uint16_t index = free_head;
+  free_head      = desc[index].next;
+  --num_free;
+  return index;
+}
+
+static void free_chain(uint16_t head) {
+  uint16_t index = head;
+  while (true) {
+    ++num_free;
+    if ((desc[index].flags & VIRTQ_DESC_F_NEXT) == 0) {
+      break;
+    }
+    index = desc[index].next;
+  }
+  desc[index].next = free_head;
+  free_head        = head;
+}
+
+// Builds one virtio request out of `count` client requests that cover consecutive sectors.
+// Segments that are physically contiguous share a descriptor.
+static uint16_t push_chain(struct blk_request* requests, size_t count) {
+  uint16_t head = alloc_desc();
+
+  headers[head].type     = requests[0].op == BLK_OP_WRITE ? VIRTIO_BLK_T_OUT : VIRTIO_BLK_T_IN;
+  headers[head].reserved = 0;
+  headers[head].sector   = requests[0].sector;
+
+  desc[head].addr  = queue_phys_addr + QUEUE_HEADER_OFFSET + sizeof(struct virtio_blk_req_header) * head;
+  desc[head].len   = sizeof(struct virtio_blk_req_header);
+  desc[head].flags = VIRTQ_DESC_F_NEXT;
+
+  uint16_t data_flags = VIRTQ_DESC_F_NEXT | (requests[0].op == BLK_OP_WRITE ? 0 : VIRTQ_DESC_F_WRITE);
+  uint16_t prev       = head;
+
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t j = 0; j < requests[i].num_segments; ++j) {
+      const struct blk_segment* segment = &requests[i].segments[j];
+
+      if (prev != head && desc[prev].addr + desc[prev].len == segment->phys_addr && (uint64_t)desc[prev].len + segment->size <= UINT32_MAX) {
+        desc[prev].len += segment->size;
+        continue;
+      }
+
+      uint16_t index    = alloc_desc();
+      desc[index].addr  = segment->phys_addr;
+      desc[index].len   = segment->size;
+      desc[index].flags = data_flags;
+      desc[prev].next   = index;
+      prev              = index;
+    }
+  }
+
+  uint16_t status_index    = alloc_desc();
+  statuses[head]           = 0xff;
+  desc[status_index].addr  = queue_phys_addr + QUEUE_STATUS_OFFSET + head;
+  desc[status_index].len   = 1;
+  desc[status_index].flags = VIRTQ_DESC_F_WRITE;
+  desc[prev].next          = status_index;
+
+  avail->ring[avail->idx % queue_size] = head;
+  __sync_synchronize();
+  ++avail->idx;
+
+  return head;
+}
+
+void blk_submit(struct blk_request* requests, size_t num_requests) {
+  size_t next      = 0;
+  size_t in_flight = 0;
+
+  while (next < num_requests || in_flight > 0) {
+    bool pushed = false;
+
+    while (next < num_requests) {
+      size_t count     = 1;
+      size_t num_descs = 2 + requests[next].num_segments;
+      size_t sector    = requests[next].sector + request_sectors(&requests[next]);
+
+      while (next + count < num_requests) {
+        const struct blk_request* request = &requests[next + count];
+        if (request->op != requests[next].op || request->sector != sector || num_descs + request->num_segments > queue_size) {
+          break;
+        }
+        num_descs += request->num_segments;
+        sector    += request_sectors(request);
+        ++count;
+      }
+
+      if (num_descs > num_free) {
+        break;
+      }
+
+      uint16_t head        = push_chain(&requests[next], count);
+      inflight_first[head] = next;
+      inflight_count[head] = count;
+
+      next   += count;
+      pushed  = true;
+      ++in_flight;
+    }
+
+    if (pushed) {
+      write32(VIRTIO_MMIO_QUEUE_NOTIFY, 0);
+    }
+
+    while (*(volatile uint16_t*)&used->idx == last_used_idx) {
+      sys_system_yield();
+    }
+    __sync_synchronize();
+
+    while (last_used_idx != *(volatile uint16_t*)&used->idx) {
+      uint16_t head   = used->ring[last_used_idx % queue_size].id;
+      int      result = statuses[head] == VIRTIO_BLK_S_OK ? BLK_CODE_S_OK : BLK_CODE_E_IO;
+
+      for (size_t i = 0; i < inflight_count[head]; ++i) {
+        requests[inflight_first[head] + i].result = result;
+      }
+
+      free_chain(head);
+      ++last_used_idx;
+      --in_flight;
+    }
+
+    write32(VIRTIO_MMIO_INTERRUPT_ACK, read32(VIRTIO_MMIO_INTERRUPT_STATUS));
+  }
+}
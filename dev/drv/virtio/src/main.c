@@ -1,3 +1,38 @@
-int main() {
+#include "blk.h"
+#include "server.h"
+
+#include <crt/global.h>
+#include <libcaprese/syscall.h>
+#include <service/mm.h>
+#include <stdlib.h>
+
+int main(void) {
+  endpoint_cap_t dm_ep_cap = __init_context.__arg_regs[0];
+  if (unwrap_sysret(sys_cap_type(dm_ep_cap)) != CAP_ENDPOINT) {
+    abort();
+  }
+
+  char       msg_buf[sizeof(struct message_header) + sizeof(uintptr_t) * 2];
+  message_t* msg               = (message_t*)msg_buf;
+  msg->header.payload_length   = 0;
+  msg->header.payload_capacity = sizeof(msg_buf) - sizeof(struct message_header);
+
+  unwrap_sysret(sys_endpoint_cap_receive(dm_ep_cap, msg));
+
+  mem_cap_t mem_cap = move_ipc_cap(msg, 0);
+  uintptr_t offset  = get_ipc_data(msg, 1);
+
+  virt_page_cap_t vp_cap    = unwrap_sysret(sys_mem_cap_create_virt_page_object(mem_cap, true, true, false, KILO_PAGE));
+  uintptr_t       base_addr = mm_vpmap(__mm_id_cap, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, vp_cap, 0);
+  if (base_addr == 0) {
+    abort();
+  }
+
+  if (!init_blk(base_addr + offset)) {
+    abort();
+  }
+
+  run();
+
   return 0;
 }
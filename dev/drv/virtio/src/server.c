@@ -0,0 +1,179 @@
+#include "server.h"
+
+#include "blk.h"
+
+#include <assert.h>
+#include <blk/ipc.h>
+#include <crt/global.h>
+#include <internal/branch.h>
+#include <libcaprese/syscall.h>
+#include <service/mm.h>
+#include <stdbool.h>
+
+static void proc_info(message_t* msg) {
+  assert(msg != NULL);
+  assert(get_ipc_data(msg, 0) == BLK_MSG_TYPE_INFO);
+
+  destroy_ipc_message(msg);
+  set_ipc_data(msg, 0, BLK_CODE_S_OK);
+  set_ipc_data(msg, 1, BLK_SECTOR_SIZE);
+  set_ipc_data(msg, 2, blk_capacity());
+  set_ipc_data(msg, 3, blk_read_only());
+}
+
+static int parse_segment(message_t* msg, size_t index, struct blk_segment* segment) {
+  __if_unlikely (!is_ipc_cap(msg, index)) {
+    return BLK_CODE_E_ILL_ARGS;
+  }
+
+  mem_cap_t mem_cap = get_ipc_cap(msg, index);
+  size_t    offset  = get_ipc_data(msg, index + 1);
+  size_t    size    = get_ipc_data(msg, index + 2);
+
+  __if_unlikely (unwrap_sysret(sys_cap_type(mem_cap)) != CAP_MEM || unwrap_sysret(sys_mem_cap_device(mem_cap))) {
+    return BLK_CODE_E_ILL_ARGS;
+  }
+
+  __if_unlikely (size == 0 || size % BLK_SECTOR_SIZE != 0 || offset + size < offset || offset + size > unwrap_sysret(sys_mem_cap_size(mem_cap))) {
+    return BLK_CODE_E_ILL_ARGS;
+  }
+
+  segment->phys_addr = unwrap_sysret(sys_mem_cap_phys_addr(mem_cap)) + offset;
+  segment->size      = size;
+
+  return BLK_CODE_S_OK;
+}
+
+static void proc_submit(message_t* msg) {
+  assert(msg != NULL);
+  assert(get_ipc_data(msg, 0) == BLK_MSG_TYPE_SUBMIT);
+
+  size_t num_requests = get_ipc_data(msg, 1);
+  __if_unlikely (num_requests == 0 || num_requests > BLK_MAX_REQUESTS) {
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, BLK_CODE_E_ILL_ARGS);
+    return;
+  }
+
+  // Every declared segment occupies the message whether its request turns out valid or not, so all of them are counted
+  // before anything is parsed.
+  size_t total_segments = 0;
+  for (size_t i = 0, index = 2; i < num_requests; ++i) {
+    size_t request_segs = get_ipc_data(msg, index + 2);
+    __if_unlikely (request_segs == 0 || request_segs > BLK_MAX_REQUEST_SEGMENTS || total_segments + request_segs > BLK_MAX_SEGMENTS) {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, BLK_CODE_E_ILL_ARGS);
+      return;
+    }
+    total_segments += request_segs;
+    index          += 3 + request_segs * 3;
+  }
+
+  struct blk_segment segments[BLK_MAX_SEGMENTS];
+  struct blk_request requests[BLK_MAX_REQUESTS];
+  int                results[BLK_MAX_REQUESTS];
+  size_t             valid_indices[BLK_MAX_REQUESTS];
+  size_t             num_valid    = 0;
+  size_t             num_segments = 0;
+  size_t             index        = 2;
+
+  for (size_t i = 0; i < num_requests; ++i) {
+    int      op            = get_ipc_data(msg, index);
+    uint64_t sector        = get_ipc_data(msg, index + 1);
+    size_t   request_segs  = get_ipc_data(msg, index + 2);
+    index                 += 3;
+
+    struct blk_request* request = &requests[num_valid];
+    request->op                 = op;
+    request->sector             = sector;
+    request->num_segments       = request_segs;
+    request->segments           = &segments[num_segments];
+    request->result             = BLK_CODE_S_OK;
+
+    results[i] = BLK_CODE_S_OK;
+
+    size_t size = 0;
+    for (size_t j = 0; j < request_segs; ++j) {
+      if (results[i] == BLK_CODE_S_OK) {
+        results[i] = parse_segment(msg, index, &request->segments[j]);
+        if (results[i] == BLK_CODE_S_OK) {
+          size += request->segments[j].size;
+        }
+      }
+      index += 3;
+    }
+
+    if (results[i] != BLK_CODE_S_OK) {
+      continue;
+    }
+
+    uint64_t num_sectors = size / BLK_SECTOR_SIZE;
+    if (op != BLK_OP_READ && op != BLK_OP_WRITE) {
+      results[i] = BLK_CODE_E_ILL_ARGS;
+    } else if (sector > blk_capacity() || num_sectors > blk_capacity() - sector) {
+      results[i] = BLK_CODE_E_ILL_ARGS;
+    } else if (op == BLK_OP_WRITE && blk_read_only()) {
+      results[i] = BLK_CODE_E_READ_ONLY;
+    } else {
+      valid_indices[num_valid++]  = i;
+      num_segments               += request_segs;
+    }
+  }
+
+  if (num_valid > 0) {
+    blk_submit(requests, num_valid);
+  }
+
+  for (size_t i = 0; i < num_valid; ++i) {
+    results[valid_indices[i]] = requests[i].result;
+  }
+
+  destroy_ipc_message(msg);
+  set_ipc_data(msg, 0, BLK_CODE_S_OK);
+  for (size_t i = 0; i < num_requests; ++i) {
+    set_ipc_data(msg, 1 + i, results[i]);
+  }
+}
+
+static void (*const table[])(message_t*) = {
+  [0]                   = NULL,
+  [BLK_MSG_TYPE_INFO]   = proc_info,
+  [BLK_MSG_TYPE_SUBMIT] = proc_submit,
+};
+
+static void proc_msg(message_t* msg) {
+  assert(msg != NULL);
+
+  uintptr_t msg_type = get_ipc_data(msg, 0);
+
+  __if_unlikely (msg_type < BLK_MSG_TYPE_INFO || msg_type > BLK_MSG_TYPE_SUBMIT) {
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, BLK_CODE_E_ILL_ARGS);
+    return;
+  }
+
+  table[msg_type](msg);
+}
+
+noreturn void run() {
+  message_t* msg = new_ipc_message(BLK_MSG_CAPACITY);
+  sysret_t   sysret;
+
+  sysret.error = SYS_E_UNKNOWN;
+  while (true) {
+    __if_unlikely (unwrap_sysret(sys_task_cap_get_free_slot_count(__this_task_cap)) < 0x10 + BLK_MAX_SEGMENTS) {
+      cap_space_cap_t cap_space_cap = mm_fetch_and_create_cap_space_object();
+      unwrap_sysret(sys_task_cap_insert_cap_space(__this_task_cap, cap_space_cap));
+    }
+
+    if (sysret_succeeded(sysret)) {
+      sysret = sys_endpoint_cap_reply_and_receive(__this_ep_cap, msg);
+    } else {
+      sysret = sys_endpoint_cap_receive(__this_ep_cap, msg);
+    }
+
+    if (sysret_succeeded(sysret)) {
+      proc_msg(msg);
+    }
+  }
+}
@@ -0,0 +1,35 @@
+#ifndef BLK_IPC_H_
+#define BLK_IPC_H_
+
+#ifndef __cplusplus
+#include <stdint.h>
+#else // !__cplusplus
+#include <cstdint>
+#endif // __cplusplus
+
+#define BLK_MSG_TYPE_INFO   1
+#define BLK_MSG_TYPE_SUBMIT 2
+
+#define BLK_OP_READ  0
+#define BLK_OP_WRITE 1
+
+#define BLK_SECTOR_SIZE          512
+#define BLK_MAX_REQUESTS         16
+#define BLK_MAX_REQUEST_SEGMENTS 16
+#define BLK_MAX_SEGMENTS         64
+#define BLK_MSG_CAPACITY         (sizeof(uintptr_t) * (2 + BLK_MAX_REQUESTS * 3 + BLK_MAX_SEGMENTS * 3))
+
+#define BLK_CODE_S_OK        0
+#define BLK_CODE_E_FAILURE   1
+#define BLK_CODE_E_ILL_ARGS  2
+#define BLK_CODE_E_READ_ONLY 3
+#define BLK_CODE_E_IO        4
+
+// BLK_MSG_TYPE_INFO replies [1] the sector size, [2] the capacity in sectors and [3] whether the device is read-only.
+//
+// BLK_MSG_TYPE_SUBMIT carries [1] the number of requests, followed by each request as
+// [op] [first sector] [number of segments] and then [mem cap] [offset] [size] for every segment.
+// The mem caps are lent; data is transferred to and from them directly.
+// The reply carries [1 + i] the result code of the i-th request.
+
+#endif // BLK_IPC_H_
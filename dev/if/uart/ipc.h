@@ -1,8 +1,20 @@
 #ifndef UART_IPC_H_
 #define UART_IPC_H_
 
-#define UART_MSG_TYPE_PUTC 1
-#define UART_MSG_TYPE_GETC 2
+#ifndef __cplusplus
+#include <stdint.h>
+#else // !__cplusplus
+#include <cstdint>
+#endif // __cplusplus
+
+#define UART_MSG_TYPE_PUTC  1
+#define UART_MSG_TYPE_GETC  2
+#define UART_MSG_TYPE_WRITE 3
+#define UART_MSG_TYPE_READ  4
+
+#define UART_READ_MAX_SIZE  0x400
+#define UART_WRITE_MAX_SIZE 0x400
+#define UART_MSG_CAPACITY   (sizeof(uintptr_t) * 3 + UART_WRITE_MAX_SIZE)
 
 #define UART_CODE_S_OK       0
 #define UART_CODE_E_FAILURE  1
@@ -0,0 +1,8 @@
+#ifndef DM_DEV_VIRTIO_H_
+#define DM_DEV_VIRTIO_H_
+
+#include <dm/dtb.h>
+
+bool virtio_launcher(const device_tree_node& node, std::string_view executable_path);
+
+#endif // DM_DEV_VIRTIO_H_
@@ -23,13 +23,13 @@ struct device_tree_property {
 };
 
 struct device_tree_node {
-  std::string                                              name;
-  uintptr_t                                                address;
-  uint32_t                                                 address_cells;
-  uint32_t                                                 size_cells;
-  std::string                                              full_name;
-  std::map<std::string, device_tree_property, std::less<>> properties;
-  std::map<std::string, device_tree_node, std::less<>>     children;
+  std::string                                               name;
+  uintptr_t                                                 address;
+  uint32_t                                                  address_cells;
+  uint32_t                                                  size_cells;
+  std::string                                               full_name;
+  std::map<std::string, device_tree_property, std::less<>>  properties;
+  std::multimap<std::string, device_tree_node, std::less<>> children;
 };
 
 class device_tree {
@@ -43,13 +43,14 @@ class device_tree {
   device_tree_node root;
 
 private:
-  device_tree_node parse_node(std::istream& stream, uint32_t off_dt_struct, uint32_t off_dt_strings, const std::string& dir, size_t address_cells, size_t size_cells);
-  void             back_u32(std::istream& stream);
-  uint32_t         read_u32(std::istream& stream);
-  uint64_t         read_u64(std::istream& stream);
-  std::string      read_str(std::istream& stream);
-  std::string      read_str(std::istream& stream, uint32_t offset);
-  void             align(std::istream& stream);
+  device_tree_node        parse_node(std::istream& stream, uint32_t off_dt_struct, uint32_t off_dt_strings, const std::string& dir, size_t address_cells, size_t size_cells);
+  const device_tree_node* find_child(const device_tree_node& node, std::string_view name) const;
+  void                    back_u32(std::istream& stream);
+  uint32_t                read_u32(std::istream& stream);
+  uint64_t                read_u64(std::istream& stream);
+  std::string             read_str(std::istream& stream);
+  std::string             read_str(std::istream& stream, uint32_t offset);
+  void                    align(std::istream& stream);
 
 public:
   void load(const char* begin, const char* end);
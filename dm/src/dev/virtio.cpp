@@ -0,0 +1,82 @@
+#include <crt/global.h>
+#include <dm/dev/virtio.h>
+#include <dm/device_manager.h>
+#include <libcaprese/syscall.h>
+#include <service/apm.h>
+#include <service/mm.h>
+#include <string>
+
+namespace {
+  constexpr uintptr_t VIRTIO_MMIO_MAGIC_VALUE = 0x000;
+  constexpr uintptr_t VIRTIO_MMIO_DEVICE_ID   = 0x008;
+  constexpr uint32_t  VIRTIO_MMIO_MAGIC       = 0x74726976;
+  constexpr uint32_t  VIRTIO_DEVICE_ID_BLK    = 2;
+
+  size_t num_blk_devices = 0;
+
+  // QEMU populates every virtio-mmio slot in the device tree, so look at the device id before launching a driver.
+  uint32_t probe_device_id(mem_cap_t mem_cap, uintptr_t offset) {
+    sysret_t sysret = sys_mem_cap_create_virt_page_object(mem_cap, true, false, false, KILO_PAGE);
+    if (sysret_failed(sysret)) [[unlikely]] {
+      return 0;
+    }
+
+    uintptr_t va = mm_vpmap(__mm_id_cap, MM_VMAP_FLAG_READ, sysret.result, 0);
+    if (va == 0) [[unlikely]] {
+      sys_cap_destroy(sysret.result);
+      return 0;
+    }
+
+    uint32_t device_id = 0;
+    if (*reinterpret_cast<volatile uint32_t*>(va + offset + VIRTIO_MMIO_MAGIC_VALUE) == VIRTIO_MMIO_MAGIC) {
+      device_id = *reinterpret_cast<volatile uint32_t*>(va + offset + VIRTIO_MMIO_DEVICE_ID);
+    }
+
+    mm_vunmap(__mm_id_cap, va, KILO_PAGE_SIZE);
+
+    return device_id;
+  }
+} // namespace
+
+bool virtio_launcher(const device_tree_node& node, std::string_view executable_path) {
+  const device_tree_property&                      reg_prop = node.properties.at("reg");
+  const std::vector<std::pair<uintptr_t, size_t>>& regs     = reg_prop.to_reg(node.address_cells, node.size_cells);
+
+  uintptr_t page_addr = regs[0].first / KILO_PAGE_SIZE * KILO_PAGE_SIZE;
+  uintptr_t offset    = regs[0].first - page_addr;
+
+  mem_cap_t mem_cap = find_mem_cap(page_addr);
+  if (mem_cap == 0) {
+    return false;
+  }
+
+  if (probe_device_id(mem_cap, offset) != VIRTIO_DEVICE_ID_BLK) {
+    return false;
+  }
+
+  endpoint_cap_t ep_cap = mm_fetch_and_create_endpoint_object();
+  if (ep_cap == 0) [[unlikely]] {
+    return false;
+  }
+
+  std::string name     = "blk" + std::to_string(num_blk_devices);
+  task_cap_t  task_cap = apm_create(executable_path.data(), name.c_str(), APM_CREATE_FLAG_DETACHED | APM_CREATE_FLAG_SUSPENDED, nullptr);
+  if (task_cap == 0) [[unlikely]] {
+    return false;
+  }
+
+  ++num_blk_devices;
+
+  endpoint_cap_t copied_ep_cap = unwrap_sysret(sys_endpoint_cap_copy(ep_cap));
+  endpoint_cap_t dst_ep_cap    = unwrap_sysret(sys_task_cap_transfer_cap(task_cap, copied_ep_cap));
+  unwrap_sysret(sys_task_cap_set_reg(task_cap, REG_ARG_0, dst_ep_cap));
+  sys_task_cap_resume(task_cap);
+
+  message_t* msg = new_ipc_message(sizeof(uintptr_t) * 2);
+  set_ipc_cap(msg, 0, mem_cap, true);
+  set_ipc_data(msg, 1, offset);
+  unwrap_sysret(sys_endpoint_cap_send_long(ep_cap, msg));
+  delete_ipc_message(msg);
+
+  return true;
+}
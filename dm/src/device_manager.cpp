@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <charconv>
 #include <dm/dev/ns16550a.h>
+#include <dm/dev/virtio.h>
 #include <dm/device_manager.h>
 #include <libcaprese/syscall.h>
 #include <service/apm.h>
@@ -10,6 +13,13 @@ namespace {
   device_tree                                                                   dt;
   std::map<std::string, std::pair<device_launcher_t, std::string>, std::less<>> device_launchers;
   std::map<uintptr_t, mem_cap_t>                                                dev_mem_caps;
+  std::set<std::string, std::less<>>                                            launched_devices;
+
+  std::string unit_path(const device_tree_node& node) {
+    char buf[sizeof(uintptr_t) * 2];
+    auto [ptr, ec] = std::to_chars(std::begin(buf), std::end(buf), node.address, 16);
+    return node.full_name + "@" + std::string(buf, ptr);
+  }
 } // namespace
 
 bool load_dtb(const char* begin, const char* end) {
@@ -21,6 +31,22 @@ bool load_dtb(const char* begin, const char* end) {
     register_device("/soc/serial", ns16550a_launcher, "/init/ns16550a");
   }
 
+  if (dt.has_node("/soc")) {
+    const device_tree_node& soc_node = dt.get_node("/soc");
+    auto [begin, end]                = soc_node.children.equal_range("virtio_mmio");
+
+    std::vector<const device_tree_node*> virtio_nodes;
+    for (auto iter = begin; iter != end; ++iter) {
+      virtio_nodes.push_back(&iter->second);
+    }
+
+    // Launch them in address order, which is the order the devices were attached in.
+    std::ranges::sort(virtio_nodes, {}, &device_tree_node::address);
+    for (const device_tree_node* node : virtio_nodes) {
+      register_device(unit_path(*node), virtio_launcher, "/init/virtio");
+    }
+  }
+
   return true;
 }
 
@@ -30,9 +56,7 @@ const device_tree_node& lookup_node(std::string_view full_path) {
 }
 
 bool register_device(std::string_view full_path, device_launcher_t launcher, std::string_view executable_path) {
-  std::string_view name = full_path.contains('@') ? full_path.substr(0, full_path.find('@')) : full_path;
-
-  if (!dt.has_node(name)) [[unlikely]] {
+  if (!dt.has_node(full_path)) [[unlikely]] {
     return false;
   }
 
@@ -42,19 +66,41 @@ bool register_device(std::string_view full_path, device_launcher_t launcher, std
 }
 
 bool launch_device(std::string_view full_path) {
-  std::string_view name = full_path.contains('@') ? full_path.substr(0, full_path.find('@')) : full_path;
+  auto iter = device_launchers.find(full_path);
+  if (iter == device_launchers.end()) {
+    std::string_view name = full_path.contains('@') ? full_path.substr(0, full_path.find('@')) : full_path;
+    iter                  = device_launchers.find(name);
+  }
 
-  if (!device_launchers.contains(name)) [[unlikely]] {
+  if (iter == device_launchers.end()) [[unlikely]] {
     return false;
   }
 
-  if (!dt.has_node(name)) [[unlikely]] {
+  if (launched_devices.contains(iter->first)) [[unlikely]] {
     return false;
   }
 
-  const device_tree_node& node            = dt.get_node(name);
-  const auto& [launcher, executable_path] = device_launchers.find(name)->second;
-  return launcher(node, executable_path);
+  if (!dt.has_node(iter->first)) [[unlikely]] {
+    return false;
+  }
+
+  const device_tree_node& node            = dt.get_node(iter->first);
+  const auto& [launcher, executable_path] = iter->second;
+  if (!launcher(node, executable_path)) {
+    return false;
+  }
+
+  launched_devices.emplace(iter->first);
+
+  return true;
+}
+
+void launch_remaining_devices() {
+  for (const auto& [full_path, launcher] : device_launchers) {
+    if (!launched_devices.contains(full_path)) {
+      launch_device(full_path);
+    }
+  }
 }
 
 void register_mem_cap(mem_cap_t dev_mem_cap) {
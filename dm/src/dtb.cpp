@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <bit>
+#include <charconv>
 #include <dm/dtb.h>
 #include <dm/fdt.h>
 #include <iterator>
@@ -199,6 +200,30 @@ void device_tree::align(std::istream& stream) {
   }
 }
 
+// A name may carry a unit address ("virtio_mmio@10001000") to pick one of several nodes with the same name.
+const device_tree_node* device_tree::find_child(const device_tree_node& node, std::string_view name) const {
+  size_t at_pos = name.find('@');
+  if (at_pos == std::string_view::npos) {
+    auto iter = node.children.find(name);
+    return iter != node.children.end() ? &iter->second : nullptr;
+  }
+
+  uintptr_t address;
+  auto [ptr, ec] = std::from_chars(name.data() + at_pos + 1, name.data() + name.size(), address, 16);
+  if (ec != std::errc() || ptr != name.data() + name.size()) [[unlikely]] {
+    return nullptr;
+  }
+
+  auto [begin, end] = node.children.equal_range(name.substr(0, at_pos));
+  for (auto iter = begin; iter != end; ++iter) {
+    if (iter->second.address == address) {
+      return &iter->second;
+    }
+  }
+
+  return nullptr;
+}
+
 bool device_tree::has_node(std::string_view full_path) const {
   if (!full_path.starts_with('/')) [[unlikely]] {
     return false;
@@ -214,13 +239,11 @@ bool device_tree::has_node(std::string_view full_path) const {
 
     std::string_view name = path.substr(1, slash_pos - 1);
 
-    auto iter = node->children.find(name);
-    if (iter == node->children.end()) {
+    node = find_child(*node, name);
+    if (node == nullptr) {
       return false;
     }
 
-    node = &iter->second;
-
     path = path.substr(slash_pos);
   } while (!path.empty());
 
@@ -242,13 +265,11 @@ const device_tree_node& device_tree::get_node(std::string_view full_path) const
 
     std::string_view name = path.substr(1, slash_pos - 1);
 
-    auto iter = node->children.find(name);
-    if (iter == node->children.end()) {
+    node = find_child(*node, name);
+    if (node == nullptr) {
       abort();
     }
 
-    node = &iter->second;
-
     path = path.substr(slash_pos);
   } while (!path.empty());
 
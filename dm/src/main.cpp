@@ -66,6 +66,8 @@ int main() {
     return 1;
   }
 
+  launch_remaining_devices();
+
   destroy_ipc_message(msg);
   unwrap_sysret(sys_endpoint_cap_receive(__this_ep_cap, msg));
   unwrap_sysret(sys_endpoint_cap_reply(__this_ep_cap, msg));
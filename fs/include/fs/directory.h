@@ -22,6 +22,12 @@ class directory {
   directory_type                                type;
 
 public:
+  // Resumes after the last name returned, which stays valid while entries are added or removed.
+  struct cursor {
+    bool        started = false;
+    std::string last;
+  };
+
   directory(std::string_view abs_path);
 
   directory(const directory&)            = delete;
@@ -38,7 +44,8 @@ public:
   [[nodiscard]] bool               mount(endpoint_cap_t ep_cap);
   [[nodiscard]] id_cap_t           get_fs_id() const;
   [[nodiscard]] bool               get_info(fs_file_info* buffer) const;
-  [[nodiscard]] std::streamsize    read(std::streampos pos, fs_file_info* buffer);
+  [[nodiscard]] bool               read(cursor& cur, fs_file_info* buffer) const;
+  [[nodiscard]] std::streamsize    read(cursor& cur, char* buffer, std::streamsize size) const;
 
   [[nodiscard]] std::optional<std::reference_wrapper<directory>>                              find_directory(std::string_view path);
   [[nodiscard]] std::optional<std::pair<std::reference_wrapper<directory>, std::string_view>> find_mount_point(std::string_view path);
@@ -50,12 +57,13 @@ public:
   [[nodiscard]] std::optional<fs_file_info> get_info(std::string_view path) noexcept;
   [[nodiscard]] bool                        create(std::string_view path, int type) noexcept;
   [[nodiscard]] bool                        remove(std::string_view path) noexcept;
-  [[nodiscard]] id_cap_t                    open(std::string_view path) noexcept;
+  [[nodiscard]] id_cap_t                    open(std::string_view path, fs_file_info& info) noexcept;
   [[nodiscard]] bool                        close(id_cap_t fd) noexcept;
   [[nodiscard]] std::streamsize             read(id_cap_t fd, char* buffer, std::streamsize size) noexcept;
   [[nodiscard]] std::streamsize             write(id_cap_t fd, std::string_view data) noexcept;
   [[nodiscard]] bool                        seek(id_cap_t fd, std::streamoff offset, int whence) noexcept;
   [[nodiscard]] std::streampos              tell(id_cap_t fd) noexcept;
+  [[nodiscard]] std::streamsize             readfile(std::string_view path, char* buffer, std::streamsize size, size_t& file_size) noexcept;
 };
 
 #endif // FS_DIRECTORY_H_
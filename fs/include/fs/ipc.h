@@ -1,30 +1,54 @@
 #ifndef FS_IPC_H_
 #define FS_IPC_H_
 
+#include <libcaprese/ipc.h>
+
 #ifndef __cplusplus
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #else // !__cplusplus
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #endif // __cplusplus
 
-#define FS_MSG_TYPE_MOUNT   1
-#define FS_MSG_TYPE_UNMOUNT 2
-#define FS_MSG_TYPE_MOUNTED 3
-#define FS_MSG_TYPE_INFO    4
-#define FS_MSG_TYPE_CREATE  5
-#define FS_MSG_TYPE_REMOVE  6
-#define FS_MSG_TYPE_OPEN    7
-#define FS_MSG_TYPE_CLOSE   8
-#define FS_MSG_TYPE_READ    9
-#define FS_MSG_TYPE_WRITE   10
-#define FS_MSG_TYPE_SEEK    11
-#define FS_MSG_TYPE_TELL    12
+// A backend answers OPEN with the fd at [1], a channel id at [2] and the fs_file_info of the file at [3]. The fs server
+// hands the channel id to redirected clients in place of the fs id, and the backend accepts it only for the
+// FS_IS_CHANNEL_MSG_TYPE operations on that fd. The fs server reply carries the fs_file_info right after its caps, at [2]
+// with FS_CODE_S_OK and at [4] with FS_CODE_E_REDIRECT.
+// MMAP replies with an mm ticket for pages holding the file contents at [1] and the number of file bytes in them at [2].
+// READ answered with FS_CODE_E_AGAIN carries an endpoint at [1]. Receiving on it blocks until the backend may have data,
+// and the read is then made again.
+// READFILE replies with the size of the file at a path followed by up to the requested number of bytes from its start.
+#define FS_MSG_TYPE_MOUNT    1
+#define FS_MSG_TYPE_UNMOUNT  2
+#define FS_MSG_TYPE_MOUNTED  3
+#define FS_MSG_TYPE_INFO     4
+#define FS_MSG_TYPE_CREATE   5
+#define FS_MSG_TYPE_REMOVE   6
+#define FS_MSG_TYPE_OPEN     7
+#define FS_MSG_TYPE_CLOSE    8
+#define FS_MSG_TYPE_READ     9
+#define FS_MSG_TYPE_WRITE    10
+#define FS_MSG_TYPE_SEEK     11
+#define FS_MSG_TYPE_TELL     12
+#define FS_MSG_TYPE_MMAP     13
+#define FS_MSG_TYPE_TRUNCATE 14
+#define FS_MSG_TYPE_READDIR  15
+#define FS_MSG_TYPE_PREAD    16
+#define FS_MSG_TYPE_PWRITE   17
+#define FS_MSG_TYPE_PREADV   18
+#define FS_MSG_TYPE_PWRITEV  19
+#define FS_MSG_TYPE_READFILE 20
+
+// The operations on an open fd, which are the ones a channel id admits.
+#define FS_IS_CHANNEL_MSG_TYPE(type) ((type) >= FS_MSG_TYPE_READ && (type) <= FS_MSG_TYPE_PWRITEV)
 
 #define FS_READ_MAX_SIZE  0x1000
 #define FS_WRITE_MAX_SIZE 0x1000
-#define FS_MSG_CAPACITY   (sizeof(uintptr_t) * 4 + FS_READ_MAX_SIZE)
+#define FS_IOV_MAX        16
+#define FS_MSG_CAPACITY   (sizeof(uintptr_t) * 4 + sizeof(struct fs_iovec) * FS_IOV_MAX + FS_READ_MAX_SIZE)
 
 #define FS_CODE_S_OK           0
 #define FS_CODE_E_FAILURE      1
@@ -35,18 +59,62 @@
 #define FS_CODE_E_REDIRECT     6
 #define FS_CODE_E_UNSUPPORTED  7
 #define FS_CODE_E_TYPE         8
+#define FS_CODE_E_AGAIN        9
 
 #define FS_FT_REG 1
 #define FS_FT_DIR 2
 #define FS_FT_MNT 3
+#define FS_FT_CHR 4
 
 #define FS_FILE_NAME_SIZE_MAX 0xff
 
+// A segment of FS_MSG_TYPE_PREADV and FS_MSG_TYPE_PWRITEV. The segment data travels back to back, in order.
+struct fs_iovec {
+  uint64_t offset;
+  uint64_t size;
+};
+
+// file_version changes whenever the contents of the file change. Backends that cannot tell report 0.
 struct fs_file_info {
+  uint8_t  file_type;
+  uint8_t  file_name_size;
+  size_t   file_size;
+  uint64_t file_version;
+  char     file_name[FS_FILE_NAME_SIZE_MAX];
+};
+
+// FS_MSG_TYPE_READDIR replies with entries packed back to back, each an fs_dirent followed by the name and a '\0'.
+struct fs_dirent {
   uint8_t file_type;
   uint8_t file_name_size;
-  size_t  file_size;
-  char    file_name[FS_FILE_NAME_SIZE_MAX];
 };
 
+#define FS_DIRENT_SIZE(name_size) (sizeof(struct fs_dirent) + (name_size) + 1)
+
+// Copies the segment count at [index] and the segments after it out of msg into iov, which holds FS_IOV_MAX entries.
+// Returns the total size of the segments, or 0 if they are malformed or exceed max_size.
+inline static size_t fs_get_iovec(message_t* msg, size_t index, struct fs_iovec* iov, size_t* count, size_t max_size) {
+  *count = get_ipc_data(msg, index);
+  if (*count == 0 || *count > FS_IOV_MAX) {
+    return 0;
+  }
+
+  const void* data = get_ipc_data_ptr(msg, index + 1);
+  if (data == NULL) {
+    return 0;
+  }
+
+  memcpy(iov, data, sizeof(struct fs_iovec) * *count);
+
+  size_t total = 0;
+  for (size_t i = 0; i < *count; ++i) {
+    if (iov[i].size > max_size - total) {
+      return 0;
+    }
+    total += iov[i].size;
+  }
+
+  return total;
+}
+
 #endif // FS_IPC_H_
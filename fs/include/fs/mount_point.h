@@ -15,9 +15,11 @@ class mount_point {
 
   static caprese::id_map<mount_point&> fs_mount_point_table;
   static caprese::id_map<id_cap_t>     fd_fs_table;
+  static caprese::id_map<id_cap_t>     fd_channel_table;
 
 public:
   [[nodiscard]] static std::optional<std::reference_wrapper<mount_point>> find_mount_point(id_cap_t fd) noexcept;
+  [[nodiscard]] static id_cap_t                                           find_channel(id_cap_t fd) noexcept;
 
 public:
   mount_point(id_cap_t id, endpoint_cap_t ep) noexcept;
@@ -31,18 +33,27 @@ public:
   [[nodiscard]] bool mount() noexcept;
   [[nodiscard]] bool unmount() noexcept;
 
-  [[nodiscard]] id_cap_t get_fs_id() const noexcept;
-  [[nodiscard]] bool     is_mounted() const noexcept;
+  [[nodiscard]] id_cap_t       get_fs_id() const noexcept;
+  [[nodiscard]] endpoint_cap_t get_fs_ep() const noexcept;
+  [[nodiscard]] bool           is_mounted() const noexcept;
 
   [[nodiscard]] std::optional<fs_file_info> get_info(std::string_view path) noexcept;
   [[nodiscard]] bool                        create(std::string_view path, int type) noexcept;
   [[nodiscard]] bool                        remove(std::string_view path) noexcept;
-  [[nodiscard]] id_cap_t                    open(std::string_view path) noexcept;
+  [[nodiscard]] id_cap_t                    open(std::string_view path, fs_file_info& info) noexcept;
   [[nodiscard]] bool                        close(id_cap_t fd) noexcept;
-  [[nodiscard]] std::streamsize             read(id_cap_t fd, char* buffer, std::streamsize size) noexcept;
+  [[nodiscard]] std::streamsize             read(id_cap_t fd, char* buffer, std::streamsize size, endpoint_cap_t& wait_ep) noexcept;
   [[nodiscard]] std::streamsize             write(id_cap_t fd, std::string_view data) noexcept;
   [[nodiscard]] bool                        seek(id_cap_t fd, std::streamoff offset, int whence) noexcept;
   [[nodiscard]] std::streampos              tell(id_cap_t fd) noexcept;
+  [[nodiscard]] id_cap_t                    mmap(id_cap_t fd, std::streamoff offset, size_t size, size_t& act_size) noexcept;
+  [[nodiscard]] bool                        truncate(id_cap_t fd, std::streamsize size) noexcept;
+  [[nodiscard]] std::streamsize             readdir(id_cap_t fd, char* buffer, std::streamsize size) noexcept;
+  [[nodiscard]] std::streamsize             pread(id_cap_t fd, std::streampos pos, char* buffer, std::streamsize size) noexcept;
+  [[nodiscard]] std::streamsize             pwrite(id_cap_t fd, std::streampos pos, std::string_view data) noexcept;
+  [[nodiscard]] bool                        preadv(id_cap_t fd, const fs_iovec* iov, size_t count, char* buffer, std::streamsize* act_sizes) noexcept;
+  [[nodiscard]] std::streamsize             pwritev(id_cap_t fd, const fs_iovec* iov, size_t count, const char* data, size_t size) noexcept;
+  [[nodiscard]] std::streamsize             readfile(std::string_view path, char* buffer, std::streamsize size, size_t& file_size) noexcept;
 };
 
 #endif // FS_MOUNT_POINT_H_
@@ -13,11 +13,20 @@
 [[nodiscard]] int vfs_get_info(std::string_view path, fs_file_info& dst);
 [[nodiscard]] int vfs_create(std::string_view path, int type);
 [[nodiscard]] int vfs_remove(std::string_view path);
-[[nodiscard]] int vfs_open(std::string_view path, id_cap_t& fd);
+[[nodiscard]] int vfs_open(std::string_view path, id_cap_t& fd, fs_file_info& info);
+[[nodiscard]] int vfs_redirect(id_cap_t fd, endpoint_cap_t& ep_cap, id_cap_t& channel);
 [[nodiscard]] int vfs_close(id_cap_t fd);
-[[nodiscard]] int vfs_read(id_cap_t fd, char* buffer, std::streamsize size, std::streamsize& act_size);
+[[nodiscard]] int vfs_read(id_cap_t fd, char* buffer, std::streamsize size, std::streamsize& act_size, endpoint_cap_t& wait_ep);
 [[nodiscard]] int vfs_write(id_cap_t fd, std::string_view data, std::streamsize& act_size);
 [[nodiscard]] int vfs_seek(id_cap_t fd, std::streamoff offset, int whence);
 [[nodiscard]] int vfs_tell(id_cap_t fd, std::streampos& dst);
+[[nodiscard]] int vfs_mmap(id_cap_t fd, std::streamoff offset, size_t size, id_cap_t& ticket, size_t& act_size);
+[[nodiscard]] int vfs_truncate(id_cap_t fd, std::streamsize size);
+[[nodiscard]] int vfs_readdir(id_cap_t fd, char* buffer, std::streamsize size, std::streamsize& act_size);
+[[nodiscard]] int vfs_pread(id_cap_t fd, std::streampos pos, char* buffer, std::streamsize size, std::streamsize& act_size);
+[[nodiscard]] int vfs_pwrite(id_cap_t fd, std::streampos pos, std::string_view data, std::streamsize& act_size);
+[[nodiscard]] int vfs_preadv(id_cap_t fd, const fs_iovec* iov, size_t count, char* buffer, std::streamsize* act_sizes);
+[[nodiscard]] int vfs_pwritev(id_cap_t fd, const fs_iovec* iov, size_t count, std::string_view data, std::streamsize& act_size);
+[[nodiscard]] int vfs_readfile(std::string_view path, char* buffer, std::streamsize size, std::streamsize& act_size, size_t& file_size);
 
 #endif // FS_FILESYSTEM_H_
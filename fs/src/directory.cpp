@@ -1,4 +1,6 @@
 #include <cassert>
+#include <cerrno>
+#include <cstring>
 #include <fs/directory.h>
 #include <libcaprese/syscall.h>
 #include <utility>
@@ -69,7 +71,8 @@ id_cap_t directory::get_fs_id() const {
 }
 
 bool directory::get_info(fs_file_info* buffer) const {
-  buffer->file_size = 0;
+  buffer->file_size    = 0;
+  buffer->file_version = 0;
 
   switch (this->type) {
     case directory_type::regular_directory:
@@ -90,23 +93,61 @@ bool directory::get_info(fs_file_info* buffer) const {
   return true;
 }
 
-std::streamsize directory::read(std::streampos pos, fs_file_info* buffer) {
+bool directory::read(cursor& cur, fs_file_info* buffer) const {
   if (mnt) [[unlikely]] {
-    return 0;
+    return false;
   }
 
-  if (pos < 0 || subdirs.size() <= static_cast<size_t>(pos)) [[unlikely]] {
-    return 0;
+  auto iter = cur.started ? subdirs.upper_bound(cur.last) : subdirs.begin();
+  if (iter == subdirs.end()) {
+    return false;
   }
 
-  auto iter = subdirs.begin();
-  std::advance(iter, static_cast<size_t>(pos));
-
   if (!iter->second.get_info(buffer)) [[unlikely]] {
+    return false;
+  }
+
+  cur.last    = iter->first;
+  cur.started = true;
+
+  return true;
+}
+
+std::streamsize directory::read(cursor& cur, char* buffer, std::streamsize size) const {
+  if (mnt) [[unlikely]] {
     return 0;
   }
 
-  return sizeof(fs_file_info);
+  char* ptr  = buffer;
+  char* end  = buffer + size;
+  auto  iter = cur.started ? subdirs.upper_bound(cur.last) : subdirs.begin();
+  auto  last = subdirs.end();
+
+  for (; iter != subdirs.end(); ++iter) {
+    size_t dirent_size = FS_DIRENT_SIZE(iter->first.size());
+    if (static_cast<size_t>(end - ptr) < dirent_size) {
+      break;
+    }
+
+    fs_dirent dirent {
+      .file_type      = static_cast<uint8_t>(iter->second.get_type()),
+      .file_name_size = static_cast<uint8_t>(iter->first.size()),
+    };
+
+    memcpy(ptr, &dirent, sizeof(dirent));
+    memcpy(ptr + sizeof(dirent), iter->first.data(), iter->first.size());
+    ptr[sizeof(dirent) + iter->first.size()] = '\0';
+    ptr += dirent_size;
+
+    last = iter;
+  }
+
+  if (last != subdirs.end()) {
+    cur.last    = last->first;
+    cur.started = true;
+  }
+
+  return ptr - buffer;
 }
 
 std::optional<std::reference_wrapper<directory>> directory::find_directory(std::string_view path) {
@@ -340,12 +381,12 @@ bool directory::remove(std::string_view path) noexcept {
   return this->mnt->remove(path);
 }
 
-id_cap_t directory::open(std::string_view path) noexcept {
+id_cap_t directory::open(std::string_view path, fs_file_info& info) noexcept {
   if (this->type != directory_type::mount_point) [[unlikely]] {
     return false;
   }
 
-  return this->mnt->open(path);
+  return this->mnt->open(path, info);
 }
 
 bool directory::close(id_cap_t id) noexcept {
@@ -387,3 +428,12 @@ std::streampos directory::tell(id_cap_t id) noexcept {
 
   return this->mnt->tell(id);
 }
+
+std::streamsize directory::readfile(std::string_view path, char* buffer, std::streamsize size, size_t& file_size) noexcept {
+  if (this->type != directory_type::mount_point) [[unlikely]] {
+    errno = FS_CODE_E_TYPE;
+    return -1;
+  }
+
+  return this->mnt->readfile(path, buffer, size, file_size);
+}
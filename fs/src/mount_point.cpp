@@ -5,6 +5,7 @@
 
 caprese::id_map<mount_point&> mount_point::fs_mount_point_table;
 caprese::id_map<id_cap_t>     mount_point::fd_fs_table;
+caprese::id_map<id_cap_t>     mount_point::fd_channel_table;
 
 std::optional<std::reference_wrapper<mount_point>> mount_point::find_mount_point(id_cap_t fd) noexcept {
   if (!fd_fs_table.contains(fd)) [[unlikely]] {
@@ -19,6 +20,14 @@ std::optional<std::reference_wrapper<mount_point>> mount_point::find_mount_point
   return fs_mount_point_table.at(fs_id);
 }
 
+id_cap_t mount_point::find_channel(id_cap_t fd) noexcept {
+  if (!fd_channel_table.contains(fd)) [[unlikely]] {
+    return 0;
+  }
+
+  return fd_channel_table.at(fd);
+}
+
 mount_point::mount_point(id_cap_t id, endpoint_cap_t ep) noexcept: fs_id(id), fs_ep(ep), mounted(false) { }
 
 mount_point::~mount_point() noexcept {
@@ -61,6 +70,10 @@ id_cap_t mount_point::get_fs_id() const noexcept {
   return this->fs_id;
 }
 
+endpoint_cap_t mount_point::get_fs_ep() const noexcept {
+  return this->fs_ep;
+}
+
 bool mount_point::is_mounted() const noexcept {
   return this->mounted;
 }
@@ -178,14 +191,14 @@ bool mount_point::remove(std::string_view path) noexcept {
   return true;
 }
 
-id_cap_t mount_point::open(std::string_view path) noexcept {
+id_cap_t mount_point::open(std::string_view path, fs_file_info& info) noexcept {
   if (!this->mounted) [[unlikely]] {
     errno = FS_CODE_E_NOT_MOUNTED;
     return 0;
   }
 
   size_t     in_size  = sizeof(uintptr_t) * 2 + path.size() + 1;
-  size_t     out_size = sizeof(uintptr_t) * 1 + sizeof(id_cap_t);
+  size_t     out_size = sizeof(uintptr_t) * 3 + sizeof(fs_file_info);
   message_t* msg      = new_ipc_message(std::max(in_size, out_size));
   if (msg == nullptr) [[unlikely]] {
     errno = FS_CODE_E_FAILURE;
@@ -217,9 +230,30 @@ id_cap_t mount_point::open(std::string_view path) noexcept {
     return 0;
   }
 
+  id_cap_t channel = move_ipc_cap(msg, 2);
+  if (unwrap_sysret(sys_cap_type(channel)) != CAP_ID) [[unlikely]] {
+    sys_cap_destroy(channel);
+    sys_cap_destroy(fd);
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return 0;
+  }
+
+  const void* data = get_ipc_data_ptr(msg, 3);
+  if (data == nullptr) [[unlikely]] {
+    sys_cap_destroy(channel);
+    sys_cap_destroy(fd);
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return 0;
+  }
+
+  memcpy(&info, data, sizeof(info));
+
   delete_ipc_message(msg);
 
   fd_fs_table.emplace(fd, fs_id);
+  fd_channel_table.emplace(fd, channel);
 
   return fd;
 }
@@ -262,10 +296,15 @@ bool mount_point::close(id_cap_t fd) noexcept {
 
   fd_fs_table.erase(fd);
 
+  if (fd_channel_table.contains(fd)) {
+    sys_cap_destroy(fd_channel_table.at(fd));
+    fd_channel_table.erase(fd);
+  }
+
   return true;
 }
 
-std::streamsize mount_point::read(id_cap_t fd, char* buffer, std::streamsize size) noexcept {
+std::streamsize mount_point::read(id_cap_t fd, char* buffer, std::streamsize size, endpoint_cap_t& wait_ep) noexcept {
   if (!this->mounted) [[unlikely]] {
     errno = FS_CODE_E_NOT_MOUNTED;
     return -1;
@@ -310,6 +349,17 @@ std::streamsize mount_point::read(id_cap_t fd, char* buffer, std::streamsize siz
     }
 
     result = get_ipc_data(msg, 0);
+    if (result == FS_CODE_E_AGAIN) {
+      if (ptr != buffer) {
+        result = FS_CODE_S_OK;
+      } else if (!is_ipc_cap(msg, 1)) [[unlikely]] {
+        result = FS_CODE_E_FAILURE;
+      } else {
+        wait_ep = move_ipc_cap(msg, 1);
+      }
+      break;
+    }
+
     if (result != FS_CODE_S_OK && result != FS_CODE_E_EOF) [[unlikely]] {
       break;
     }
@@ -486,3 +536,451 @@ std::streampos mount_point::tell(id_cap_t fd) noexcept {
 
   return pos;
 }
+
+id_cap_t mount_point::mmap(id_cap_t fd, std::streamoff offset, size_t size, size_t& act_size) noexcept {
+  if (!this->mounted) [[unlikely]] {
+    errno = FS_CODE_E_NOT_MOUNTED;
+    return 0;
+  }
+
+  if (!fd_fs_table.contains(fd) || unwrap_sysret(sys_id_cap_compare(fd_fs_table.at(fd), this->fs_id)) != 0) [[unlikely]] {
+    errno = FS_CODE_E_ILL_ARGS;
+    return 0;
+  }
+
+  message_t* msg = new_ipc_message(sizeof(uintptr_t) * 5);
+  if (msg == nullptr) [[unlikely]] {
+    errno = FS_CODE_E_FAILURE;
+    return 0;
+  }
+
+  set_ipc_data(msg, 0, FS_MSG_TYPE_MMAP);
+  set_ipc_cap(msg, 1, fs_id, true);
+  set_ipc_cap(msg, 2, fd, true);
+  set_ipc_data(msg, 3, offset);
+  set_ipc_data(msg, 4, size);
+
+  if (sysret_failed(sys_endpoint_cap_call(fs_ep, msg))) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return 0;
+  }
+
+  if (get_ipc_data(msg, 0) != FS_CODE_S_OK) [[unlikely]] {
+    auto err = get_ipc_data(msg, 0);
+    delete_ipc_message(msg);
+    errno = err;
+    return 0;
+  }
+
+  id_cap_t ticket = move_ipc_cap(msg, 1);
+  if (unwrap_sysret(sys_cap_type(ticket)) != CAP_ID) [[unlikely]] {
+    sys_cap_destroy(ticket);
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return 0;
+  }
+
+  act_size = get_ipc_data(msg, 2);
+  delete_ipc_message(msg);
+
+  return ticket;
+}
+
+bool mount_point::truncate(id_cap_t fd, std::streamsize size) noexcept {
+  if (!this->mounted) [[unlikely]] {
+    errno = FS_CODE_E_NOT_MOUNTED;
+    return false;
+  }
+
+  if (!fd_fs_table.contains(fd) || unwrap_sysret(sys_id_cap_compare(fd_fs_table.at(fd), this->fs_id)) != 0) [[unlikely]] {
+    errno = FS_CODE_E_ILL_ARGS;
+    return false;
+  }
+
+  message_t* msg = new_ipc_message(sizeof(uintptr_t) * 4);
+  if (msg == nullptr) [[unlikely]] {
+    errno = FS_CODE_E_FAILURE;
+    return false;
+  }
+
+  set_ipc_data(msg, 0, FS_MSG_TYPE_TRUNCATE);
+  set_ipc_cap(msg, 1, fs_id, true);
+  set_ipc_cap(msg, 2, fd, true);
+  set_ipc_data(msg, 3, size);
+
+  if (sysret_failed(sys_endpoint_cap_call(fs_ep, msg))) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return false;
+  }
+
+  if (get_ipc_data(msg, 0) != FS_CODE_S_OK) [[unlikely]] {
+    auto err = get_ipc_data(msg, 0);
+    delete_ipc_message(msg);
+    errno = err;
+    return false;
+  }
+
+  delete_ipc_message(msg);
+
+  return true;
+}
+
+std::streamsize mount_point::readdir(id_cap_t fd, char* buffer, std::streamsize size) noexcept {
+  if (!this->mounted) [[unlikely]] {
+    errno = FS_CODE_E_NOT_MOUNTED;
+    return -1;
+  }
+
+  if (!fd_fs_table.contains(fd) || unwrap_sysret(sys_id_cap_compare(fd_fs_table.at(fd), this->fs_id)) != 0) [[unlikely]] {
+    errno = FS_CODE_E_ILL_ARGS;
+    return -1;
+  }
+
+  if (buffer == nullptr || size > FS_READ_MAX_SIZE) [[unlikely]] {
+    errno = FS_CODE_E_ILL_ARGS;
+    return -1;
+  }
+
+  message_t* msg = new_ipc_message(sizeof(uintptr_t) * 4 + size);
+  if (msg == nullptr) [[unlikely]] {
+    errno = FS_CODE_E_FAILURE;
+    return -1;
+  }
+
+  set_ipc_data(msg, 0, FS_MSG_TYPE_READDIR);
+  set_ipc_cap(msg, 1, fs_id, true);
+  set_ipc_cap(msg, 2, fd, true);
+  set_ipc_data(msg, 3, size);
+
+  if (sysret_failed(sys_endpoint_cap_call(fs_ep, msg))) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return -1;
+  }
+
+  int result = get_ipc_data(msg, 0);
+  if (result != FS_CODE_S_OK) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = result;
+    return -1;
+  }
+
+  size_t act_size = get_ipc_data(msg, 1);
+  if (act_size > static_cast<size_t>(size)) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return -1;
+  }
+
+  const void* data = get_ipc_data_ptr(msg, 2);
+  if (data == nullptr) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return -1;
+  }
+
+  memcpy(buffer, data, act_size);
+
+  delete_ipc_message(msg);
+
+  return act_size;
+}
+
+std::streamsize mount_point::pread(id_cap_t fd, std::streampos pos, char* buffer, std::streamsize size) noexcept {
+  if (!this->mounted) [[unlikely]] {
+    errno = FS_CODE_E_NOT_MOUNTED;
+    return -1;
+  }
+
+  if (!fd_fs_table.contains(fd) || unwrap_sysret(sys_id_cap_compare(fd_fs_table.at(fd), this->fs_id)) != 0) [[unlikely]] {
+    errno = FS_CODE_E_ILL_ARGS;
+    return -1;
+  }
+
+  if (buffer == nullptr || size > FS_READ_MAX_SIZE) [[unlikely]] {
+    errno = FS_CODE_E_ILL_ARGS;
+    return -1;
+  }
+
+  message_t* msg = new_ipc_message(sizeof(uintptr_t) * 4 + size);
+  if (msg == nullptr) [[unlikely]] {
+    errno = FS_CODE_E_FAILURE;
+    return -1;
+  }
+
+  set_ipc_data(msg, 0, FS_MSG_TYPE_PREAD);
+  set_ipc_cap(msg, 1, fs_id, true);
+  set_ipc_cap(msg, 2, fd, true);
+  set_ipc_data(msg, 3, pos);
+  set_ipc_data(msg, 4, size);
+
+  if (sysret_failed(sys_endpoint_cap_call(fs_ep, msg))) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return -1;
+  }
+
+  int result = get_ipc_data(msg, 0);
+  if (result != FS_CODE_S_OK && result != FS_CODE_E_EOF) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = result;
+    return -1;
+  }
+
+  size_t act_size = get_ipc_data(msg, 1);
+  if (act_size > static_cast<size_t>(size)) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return -1;
+  }
+
+  if (act_size > 0) {
+    const void* data = get_ipc_data_ptr(msg, 2);
+    if (data == nullptr) [[unlikely]] {
+      delete_ipc_message(msg);
+      errno = FS_CODE_E_FAILURE;
+      return -1;
+    }
+
+    memcpy(buffer, data, act_size);
+  }
+
+  delete_ipc_message(msg);
+
+  return act_size;
+}
+
+std::streamsize mount_point::pwrite(id_cap_t fd, std::streampos pos, std::string_view data) noexcept {
+  if (!this->mounted) [[unlikely]] {
+    errno = FS_CODE_E_NOT_MOUNTED;
+    return -1;
+  }
+
+  if (!fd_fs_table.contains(fd) || unwrap_sysret(sys_id_cap_compare(fd_fs_table.at(fd), this->fs_id)) != 0) [[unlikely]] {
+    errno = FS_CODE_E_ILL_ARGS;
+    return -1;
+  }
+
+  if (data.size() > FS_WRITE_MAX_SIZE) [[unlikely]] {
+    errno = FS_CODE_E_ILL_ARGS;
+    return -1;
+  }
+
+  message_t* msg = new_ipc_message(sizeof(uintptr_t) * 5 + data.size());
+  if (msg == nullptr) [[unlikely]] {
+    errno = FS_CODE_E_FAILURE;
+    return -1;
+  }
+
+  set_ipc_data(msg, 0, FS_MSG_TYPE_PWRITE);
+  set_ipc_cap(msg, 1, fs_id, true);
+  set_ipc_cap(msg, 2, fd, true);
+  set_ipc_data(msg, 3, pos);
+  set_ipc_data(msg, 4, data.size());
+  set_ipc_data_array(msg, 5, data.data(), data.size());
+
+  if (sysret_failed(sys_endpoint_cap_call(fs_ep, msg))) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return -1;
+  }
+
+  int result = get_ipc_data(msg, 0);
+  if (result != FS_CODE_S_OK && result != FS_CODE_E_EOF) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = result;
+    return -1;
+  }
+
+  std::streamsize act_size = get_ipc_data(msg, 1);
+
+  delete_ipc_message(msg);
+
+  return act_size;
+}
+
+bool mount_point::preadv(id_cap_t fd, const fs_iovec* iov, size_t count, char* buffer, std::streamsize* act_sizes) noexcept {
+  if (!this->mounted) [[unlikely]] {
+    errno = FS_CODE_E_NOT_MOUNTED;
+    return false;
+  }
+
+  if (!fd_fs_table.contains(fd) || unwrap_sysret(sys_id_cap_compare(fd_fs_table.at(fd), this->fs_id)) != 0) [[unlikely]] {
+    errno = FS_CODE_E_ILL_ARGS;
+    return false;
+  }
+
+  if (count == 0 || count > FS_IOV_MAX) [[unlikely]] {
+    errno = FS_CODE_E_ILL_ARGS;
+    return false;
+  }
+
+  message_t* msg = new_ipc_message(FS_MSG_CAPACITY);
+  if (msg == nullptr) [[unlikely]] {
+    errno = FS_CODE_E_FAILURE;
+    return false;
+  }
+
+  set_ipc_data(msg, 0, FS_MSG_TYPE_PREADV);
+  set_ipc_cap(msg, 1, fs_id, true);
+  set_ipc_cap(msg, 2, fd, true);
+  set_ipc_data(msg, 3, count);
+  set_ipc_data_array(msg, 4, iov, sizeof(fs_iovec) * count);
+
+  if (sysret_failed(sys_endpoint_cap_call(fs_ep, msg))) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return false;
+  }
+
+  int result = get_ipc_data(msg, 0);
+  if (result != FS_CODE_S_OK) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = result;
+    return false;
+  }
+
+  if (get_ipc_data(msg, 1) != count) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return false;
+  }
+
+  size_t total = 0;
+  for (size_t i = 0; i < count; ++i) {
+    act_sizes[i] = get_ipc_data(msg, 2 + i);
+    if (static_cast<uint64_t>(act_sizes[i]) > iov[i].size) [[unlikely]] {
+      delete_ipc_message(msg);
+      errno = FS_CODE_E_FAILURE;
+      return false;
+    }
+    total += act_sizes[i];
+  }
+
+  if (total > 0) {
+    const void* data = get_ipc_data_ptr(msg, 2 + count);
+    if (data == nullptr) [[unlikely]] {
+      delete_ipc_message(msg);
+      errno = FS_CODE_E_FAILURE;
+      return false;
+    }
+
+    memcpy(buffer, data, total);
+  }
+
+  delete_ipc_message(msg);
+
+  return true;
+}
+
+std::streamsize mount_point::pwritev(id_cap_t fd, const fs_iovec* iov, size_t count, const char* data, size_t size) noexcept {
+  if (!this->mounted) [[unlikely]] {
+    errno = FS_CODE_E_NOT_MOUNTED;
+    return -1;
+  }
+
+  if (!fd_fs_table.contains(fd) || unwrap_sysret(sys_id_cap_compare(fd_fs_table.at(fd), this->fs_id)) != 0) [[unlikely]] {
+    errno = FS_CODE_E_ILL_ARGS;
+    return -1;
+  }
+
+  if (count == 0 || count > FS_IOV_MAX || size > FS_WRITE_MAX_SIZE) [[unlikely]] {
+    errno = FS_CODE_E_ILL_ARGS;
+    return -1;
+  }
+
+  message_t* msg = new_ipc_message(FS_MSG_CAPACITY);
+  if (msg == nullptr) [[unlikely]] {
+    errno = FS_CODE_E_FAILURE;
+    return -1;
+  }
+
+  set_ipc_data(msg, 0, FS_MSG_TYPE_PWRITEV);
+  set_ipc_cap(msg, 1, fs_id, true);
+  set_ipc_cap(msg, 2, fd, true);
+  set_ipc_data(msg, 3, count);
+  set_ipc_data_array(msg, 4, iov, sizeof(fs_iovec) * count);
+  set_ipc_data_array(msg, 4 + sizeof(fs_iovec) * count / sizeof(uintptr_t), data, size);
+
+  if (sysret_failed(sys_endpoint_cap_call(fs_ep, msg))) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return -1;
+  }
+
+  int result = get_ipc_data(msg, 0);
+  if (result != FS_CODE_S_OK && result != FS_CODE_E_EOF) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = result;
+    return -1;
+  }
+
+  std::streamsize act_size = get_ipc_data(msg, 1);
+
+  delete_ipc_message(msg);
+
+  return act_size;
+}
+
+std::streamsize mount_point::readfile(std::string_view path, char* buffer, std::streamsize size, size_t& file_size) noexcept {
+  if (!this->mounted) [[unlikely]] {
+    errno = FS_CODE_E_NOT_MOUNTED;
+    return -1;
+  }
+
+  if (buffer == nullptr || size > FS_READ_MAX_SIZE) [[unlikely]] {
+    errno = FS_CODE_E_ILL_ARGS;
+    return -1;
+  }
+
+  size_t     in_size  = sizeof(uintptr_t) * 3 + path.size() + 1;
+  size_t     out_size = sizeof(uintptr_t) * 3 + size;
+  message_t* msg      = new_ipc_message(std::max(in_size, out_size));
+  if (msg == nullptr) [[unlikely]] {
+    errno = FS_CODE_E_FAILURE;
+    return -1;
+  }
+
+  set_ipc_data(msg, 0, FS_MSG_TYPE_READFILE);
+  set_ipc_cap(msg, 1, fs_id, true);
+  set_ipc_data(msg, 2, size);
+  set_ipc_data_strn(msg, 3, path.data(), path.size());
+
+  if (sysret_failed(sys_endpoint_cap_call(fs_ep, msg))) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return -1;
+  }
+
+  int result = get_ipc_data(msg, 0);
+  if (result != FS_CODE_S_OK) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = result;
+    return -1;
+  }
+
+  file_size       = get_ipc_data(msg, 1);
+  size_t act_size = get_ipc_data(msg, 2);
+  if (act_size > static_cast<size_t>(size)) [[unlikely]] {
+    delete_ipc_message(msg);
+    errno = FS_CODE_E_FAILURE;
+    return -1;
+  }
+
+  if (act_size > 0) {
+    const void* data = get_ipc_data_ptr(msg, 3);
+    if (data == nullptr) [[unlikely]] {
+      delete_ipc_message(msg);
+      errno = FS_CODE_E_FAILURE;
+      return -1;
+    }
+
+    memcpy(buffer, data, act_size);
+  }
+
+  delete_ipc_message(msg);
+
+  return act_size;
+}
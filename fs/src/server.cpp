@@ -1,5 +1,6 @@
 #include <cerrno>
 #include <crt/global.h>
+#include <cstring>
 #include <fs/ipc.h>
 #include <fs/server.h>
 #include <fs/vfs.h>
@@ -149,8 +150,9 @@ namespace {
       return;
     }
 
-    id_cap_t fd;
-    int      result = vfs_open(c_path, fd);
+    id_cap_t     fd;
+    fs_file_info info;
+    int          result = vfs_open(c_path, fd, info);
 
     if (result != FS_CODE_S_OK) [[unlikely]] {
       destroy_ipc_message(msg);
@@ -159,8 +161,22 @@ namespace {
     }
 
     destroy_ipc_message(msg);
+
+    // Files served by a mounted backend are redirected, so that the data operations skip the fs server.
+    endpoint_cap_t ep_cap;
+    id_cap_t       channel;
+    if (vfs_redirect(fd, ep_cap, channel) == FS_CODE_S_OK) {
+      set_ipc_data(msg, 0, FS_CODE_E_REDIRECT);
+      set_ipc_cap(msg, 1, unwrap_sysret(sys_id_cap_copy(fd)), false);
+      set_ipc_cap(msg, 2, unwrap_sysret(sys_endpoint_cap_copy(ep_cap)), false);
+      set_ipc_cap(msg, 3, unwrap_sysret(sys_id_cap_copy(channel)), false);
+      set_ipc_data_array(msg, 4, &info, sizeof(info));
+      return;
+    }
+
     set_ipc_data(msg, 0, FS_CODE_S_OK);
     set_ipc_cap(msg, 1, unwrap_sysret(sys_id_cap_copy(fd)), false);
+    set_ipc_data_array(msg, 2, &info, sizeof(info));
   }
 
   void close(message_t* msg) {
@@ -201,7 +217,15 @@ namespace {
 
     std::unique_ptr<char[]> buffer = std::make_unique<char[]>(size);
     std::streamsize         act_size;
-    int                     result = vfs_read(fd, buffer.get(), size, act_size);
+    endpoint_cap_t          wait_ep = 0;
+    int                     result  = vfs_read(fd, buffer.get(), size, act_size, wait_ep);
+
+    if (result == FS_CODE_E_AGAIN) {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, result);
+      set_ipc_cap(msg, 1, wait_ep, false);
+      return;
+    }
 
     if (result != FS_CODE_S_OK) [[unlikely]] {
       destroy_ipc_message(msg);
@@ -295,22 +319,295 @@ namespace {
     set_ipc_data(msg, 1, pos);
   }
 
+  void mmap(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_MMAP);
+
+    id_cap_t fd = get_ipc_cap(msg, 1);
+
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::streamoff offset = get_ipc_data(msg, 2);
+    size_t         size   = get_ipc_data(msg, 3);
+
+    id_cap_t ticket;
+    size_t   act_size;
+    int      result = vfs_mmap(fd, offset, size, ticket, act_size);
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+
+    if (result != FS_CODE_S_OK) [[unlikely]] {
+      return;
+    }
+
+    set_ipc_cap(msg, 1, ticket, false);
+    set_ipc_data(msg, 2, act_size);
+  }
+
+  void truncate(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_TRUNCATE);
+
+    id_cap_t fd = get_ipc_cap(msg, 1);
+
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::streamsize size = get_ipc_data(msg, 2);
+
+    int result = vfs_truncate(fd, size);
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+  }
+
+  void readdir(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_READDIR);
+
+    id_cap_t fd = get_ipc_cap(msg, 1);
+
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    size_t size = get_ipc_data(msg, 2);
+
+    if (size > FS_READ_MAX_SIZE) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::unique_ptr<char[]> buffer = std::make_unique<char[]>(size);
+    std::streamsize         act_size;
+    int                     result = vfs_readdir(fd, buffer.get(), size, act_size);
+
+    if (result != FS_CODE_S_OK) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, result);
+      return;
+    }
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, FS_CODE_S_OK);
+    set_ipc_data(msg, 1, act_size);
+    set_ipc_data_array(msg, 2, buffer.get(), act_size);
+  }
+
+  void pread(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_PREAD);
+
+    id_cap_t fd = get_ipc_cap(msg, 1);
+
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::streampos pos  = get_ipc_data(msg, 2);
+    size_t         size = get_ipc_data(msg, 3);
+
+    if (size > FS_READ_MAX_SIZE) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::unique_ptr<char[]> buffer = std::make_unique<char[]>(size);
+    std::streamsize         act_size;
+    int                     result = vfs_pread(fd, pos, buffer.get(), size, act_size);
+
+    if (result != FS_CODE_S_OK) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, result);
+      return;
+    }
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, FS_CODE_S_OK);
+    set_ipc_data(msg, 1, act_size);
+    set_ipc_data_array(msg, 2, buffer.get(), act_size);
+  }
+
+  void pwrite(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_PWRITE);
+
+    id_cap_t fd = get_ipc_cap(msg, 1);
+
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::streampos pos  = get_ipc_data(msg, 2);
+    size_t         size = get_ipc_data(msg, 3);
+
+    if (size > FS_WRITE_MAX_SIZE) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    const char* data = reinterpret_cast<const char*>(get_ipc_data_ptr(msg, 4));
+
+    if (data == nullptr) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::streamsize act_size;
+    int             result = vfs_pwrite(fd, pos, std::string_view(data, size), act_size);
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+    set_ipc_data(msg, 1, act_size);
+  }
+
+  void readfile(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_READFILE);
+
+    size_t      size   = get_ipc_data(msg, 1);
+    const char* c_path = reinterpret_cast<const char*>(get_ipc_data_ptr(msg, 2));
+
+    if (size > FS_READ_MAX_SIZE || c_path == nullptr) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::unique_ptr<char[]> buffer = std::make_unique<char[]>(size);
+    std::streamsize         act_size;
+    size_t                  file_size;
+    int                     result = vfs_readfile(c_path, buffer.get(), size, act_size, file_size);
+
+    if (result != FS_CODE_S_OK) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, result);
+      return;
+    }
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, FS_CODE_S_OK);
+    set_ipc_data(msg, 1, file_size);
+    set_ipc_data(msg, 2, act_size);
+    set_ipc_data_array(msg, 3, buffer.get(), act_size);
+  }
+
+  void preadv(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_PREADV);
+
+    id_cap_t fd = get_ipc_cap(msg, 1);
+
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    fs_iovec iov[FS_IOV_MAX];
+    size_t   count;
+    size_t   total = fs_get_iovec(msg, 2, iov, &count, FS_READ_MAX_SIZE);
+
+    if (total == 0) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::unique_ptr<char[]> buffer = std::make_unique<char[]>(total);
+    std::streamsize         act_sizes[FS_IOV_MAX];
+    int                     result = vfs_preadv(fd, iov, count, buffer.get(), act_sizes);
+
+    if (result != FS_CODE_S_OK) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, result);
+      return;
+    }
+
+    size_t act_total = 0;
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, FS_CODE_S_OK);
+    set_ipc_data(msg, 1, count);
+    for (size_t i = 0; i < count; ++i) {
+      set_ipc_data(msg, 2 + i, act_sizes[i]);
+      act_total += act_sizes[i];
+    }
+    set_ipc_data_array(msg, 2 + count, buffer.get(), act_total);
+  }
+
+  void pwritev(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_PWRITEV);
+
+    id_cap_t fd = get_ipc_cap(msg, 1);
+
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    fs_iovec iov[FS_IOV_MAX];
+    size_t   count;
+    size_t   total = fs_get_iovec(msg, 2, iov, &count, FS_WRITE_MAX_SIZE);
+
+    if (total == 0) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    const char* data = reinterpret_cast<const char*>(get_ipc_data_ptr(msg, 3 + sizeof(fs_iovec) * count / sizeof(uintptr_t)));
+
+    if (data == nullptr) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::streamsize act_size;
+    int             result = vfs_pwritev(fd, iov, count, std::string_view(data, total), act_size);
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+    set_ipc_data(msg, 1, act_size);
+  }
+
   // clang-format off
 
   constexpr void (*const table[])(message_t*) = {
-    [0]                   = nullptr,
-    [FS_MSG_TYPE_MOUNT]   = mount,
-    [FS_MSG_TYPE_UNMOUNT] = unmount,
-    [FS_MSG_TYPE_MOUNTED] = mounted,
-    [FS_MSG_TYPE_INFO]    = info,
-    [FS_MSG_TYPE_CREATE]  = create,
-    [FS_MSG_TYPE_REMOVE]  = remove,
-    [FS_MSG_TYPE_OPEN]    = open,
-    [FS_MSG_TYPE_CLOSE]   = close,
-    [FS_MSG_TYPE_READ]    = read,
-    [FS_MSG_TYPE_WRITE]   = write,
-    [FS_MSG_TYPE_SEEK]    = seek,
-    [FS_MSG_TYPE_TELL]    = tell,
+    [0]                    = nullptr,
+    [FS_MSG_TYPE_MOUNT]    = mount,
+    [FS_MSG_TYPE_UNMOUNT]  = unmount,
+    [FS_MSG_TYPE_MOUNTED]  = mounted,
+    [FS_MSG_TYPE_INFO]     = info,
+    [FS_MSG_TYPE_CREATE]   = create,
+    [FS_MSG_TYPE_REMOVE]   = remove,
+    [FS_MSG_TYPE_OPEN]     = open,
+    [FS_MSG_TYPE_CLOSE]    = close,
+    [FS_MSG_TYPE_READ]     = read,
+    [FS_MSG_TYPE_WRITE]    = write,
+    [FS_MSG_TYPE_SEEK]     = seek,
+    [FS_MSG_TYPE_TELL]     = tell,
+    [FS_MSG_TYPE_MMAP]     = mmap,
+    [FS_MSG_TYPE_TRUNCATE] = truncate,
+    [FS_MSG_TYPE_READDIR]  = readdir,
+    [FS_MSG_TYPE_PREAD]    = pread,
+    [FS_MSG_TYPE_PWRITE]   = pwrite,
+    [FS_MSG_TYPE_PREADV]   = preadv,
+    [FS_MSG_TYPE_PWRITEV]  = pwritev,
+    [FS_MSG_TYPE_READFILE] = readfile,
   };
 
   // clang-format on
@@ -4,11 +4,83 @@
 #include <functional>
 #include <libcaprese/cxx/id_map.h>
 #include <optional>
+#include <string>
+#include <unordered_map>
 #include <utility>
 
 namespace {
   std::optional<directory>    root_directory;
   caprese::id_map<dir_stream> dir_streams;
+
+  // Path resolutions are cached by full path. The directory tree is already a trie of path components, so it is only
+  // walked on a miss. An entry names the deepest mount point on the path, or the vfs directory when no mount point
+  // covers it, and may record that the backend reported the path as missing.
+  struct resolved_path {
+    directory* mnt_dir;
+    size_t     subpath_pos;
+    size_t     subpath_size;
+    directory* dir;
+    bool       missing;
+  };
+
+  struct path_hash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view path) const noexcept {
+      return std::hash<std::string_view>()(path);
+    }
+  };
+
+  constexpr size_t max_resolved_paths = 512;
+
+  std::unordered_map<std::string, resolved_path, path_hash, std::equal_to<>> resolved_paths;
+
+  resolved_path& resolve(std::string_view path) {
+    if (auto it = resolved_paths.find(path); it != resolved_paths.end()) {
+      return it->second;
+    }
+
+    if (resolved_paths.size() >= max_resolved_paths) [[unlikely]] {
+      resolved_paths.clear();
+    }
+
+    resolved_path entry { .mnt_dir = nullptr, .subpath_pos = 0, .subpath_size = 0, .dir = nullptr, .missing = false };
+
+    if (auto result = root_directory->find_mount_point(path)) {
+      auto& [directory, subpath] = result.value();
+      entry.mnt_dir              = &directory.get();
+      entry.subpath_pos          = subpath.empty() ? 0 : subpath.data() - path.data();
+      entry.subpath_size         = subpath.size();
+    } else if (auto result = root_directory->find_directory(path)) {
+      entry.dir = &result->get();
+    }
+
+    return resolved_paths.emplace(path, entry).first->second;
+  }
+
+  std::string_view get_subpath(std::string_view path, const resolved_path& entry) {
+    return path.substr(entry.subpath_pos, entry.subpath_size);
+  }
+
+  // The number of entries that may record a miss. A create, or an open that may create, can bring any of them into
+  // existence, parent directories included, and under any spelling, so all of them are dropped then.
+  size_t num_missing;
+
+  void remember_missing(resolved_path& entry) {
+    entry.missing = true;
+    ++num_missing;
+  }
+
+  void forget_missing() {
+    if (num_missing == 0) {
+      return;
+    }
+
+    for (auto& [path, entry] : resolved_paths) {
+      entry.missing = false;
+    }
+    num_missing = 0;
+  }
 } // namespace
 
 bool vfs_init() {
@@ -27,6 +99,7 @@ int vfs_mount(endpoint_cap_t ep_cap, std::string_view path, id_cap_t& fs_id) {
 
   path.remove_prefix(1);
   auto mnt_dir = root_directory->create_mount_point(path, ep_cap);
+  resolved_paths.clear();
   if (!mnt_dir) {
     return FS_CODE_E_FAILURE;
   }
@@ -42,6 +115,7 @@ int vfs_unmount(std::string_view path) {
   }
 
   path.remove_prefix(1);
+  resolved_paths.clear();
   if (!root_directory->remove_mount_point(path)) {
     return FS_CODE_E_FAILURE;
   }
@@ -67,11 +141,19 @@ int vfs_get_info(std::string_view path, fs_file_info& dst) {
 
   path.remove_prefix(1);
 
-  if (auto result = root_directory->find_mount_point(path)) {
-    auto& [directory, subpath] = result.value();
-    auto info                  = directory.get().get_info(subpath);
+  resolved_path& entry = resolve(path);
+
+  if (entry.missing) {
+    return FS_CODE_E_FAILURE;
+  }
+
+  if (entry.mnt_dir != nullptr) {
+    auto info = entry.mnt_dir->get_info(get_subpath(path, entry));
 
     if (!info) [[unlikely]] {
+      if (errno == FS_CODE_E_NO_SUCH_FILE) {
+        remember_missing(entry);
+      }
       return FS_CODE_E_FAILURE;
     }
 
@@ -80,8 +162,8 @@ int vfs_get_info(std::string_view path, fs_file_info& dst) {
     return FS_CODE_S_OK;
   }
 
-  if (auto result = root_directory->find_directory(path)) {
-    if (!result->get().get_info(&dst)) [[unlikely]] {
+  if (entry.dir != nullptr) {
+    if (!entry.dir->get_info(&dst)) [[unlikely]] {
       return FS_CODE_E_FAILURE;
     }
 
@@ -101,13 +183,13 @@ int vfs_create(std::string_view path, int type) {
   }
 
   path.remove_prefix(1);
-  auto result = root_directory->find_mount_point(path);
-  if (!result) {
+  resolved_path& entry = resolve(path);
+  if (entry.mnt_dir == nullptr) {
     return FS_CODE_E_NO_SUCH_FILE;
   }
 
-  auto& [directory, subpath] = result.value();
-  if (!directory.get().create(subpath, type)) {
+  forget_missing();
+  if (!entry.mnt_dir->create(get_subpath(path, entry), type)) {
     return FS_CODE_E_FAILURE;
   }
 
@@ -120,29 +202,31 @@ int vfs_remove(std::string_view path) {
   }
 
   path.remove_prefix(1);
-  auto result = root_directory->find_mount_point(path);
-  if (!result) {
+  resolved_path& entry = resolve(path);
+  if (entry.mnt_dir == nullptr) {
     return FS_CODE_E_NO_SUCH_FILE;
   }
 
-  auto& [directory, subpath] = result.value();
-  if (!directory.get().remove(subpath)) {
+  if (!entry.mnt_dir->remove(get_subpath(path, entry))) {
     return FS_CODE_E_FAILURE;
   }
 
   return FS_CODE_S_OK;
 }
 
-int vfs_open(std::string_view path, id_cap_t& fd) {
+int vfs_open(std::string_view path, id_cap_t& fd, fs_file_info& info) {
   if (path.empty() || path.front() != '/') [[unlikely]] {
     return FS_CODE_E_NO_SUCH_FILE;
   }
 
   path.remove_prefix(1);
 
-  if (auto result = root_directory->find_mount_point(path)) {
-    auto& [directory, subpath] = result.value();
-    fd                         = directory.get().open(subpath);
+  resolved_path& entry = resolve(path);
+
+  if (entry.mnt_dir != nullptr) {
+    // Backends may create the file on open.
+    forget_missing();
+    fd = entry.mnt_dir->open(get_subpath(path, entry), info);
     if (fd == 0) {
       return FS_CODE_E_FAILURE;
     }
@@ -150,15 +234,35 @@ int vfs_open(std::string_view path, id_cap_t& fd) {
     return FS_CODE_S_OK;
   }
 
-  if (auto result = root_directory->find_directory(path)) {
+  if (entry.dir != nullptr) {
+    if (!entry.dir->get_info(&info)) [[unlikely]] {
+      return FS_CODE_E_FAILURE;
+    }
+
     fd = unwrap_sysret(sys_id_cap_create());
-    dir_streams.emplace(fd, result->get());
+    dir_streams.emplace(fd, *entry.dir);
     return FS_CODE_S_OK;
   }
 
   return FS_CODE_E_NO_SUCH_FILE;
 }
 
+int vfs_redirect(id_cap_t fd, endpoint_cap_t& ep_cap, id_cap_t& channel) {
+  auto mnt = mount_point::find_mount_point(fd);
+  if (!mnt) {
+    return FS_CODE_E_NO_SUCH_FILE;
+  }
+
+  channel = mount_point::find_channel(fd);
+  if (channel == 0) [[unlikely]] {
+    return FS_CODE_E_NO_SUCH_FILE;
+  }
+
+  ep_cap = mnt->get().get_fs_ep();
+
+  return FS_CODE_S_OK;
+}
+
 int vfs_close(id_cap_t fd) {
   if (dir_streams.contains(fd)) {
     dir_streams.erase(fd);
@@ -177,7 +281,7 @@ int vfs_close(id_cap_t fd) {
   return FS_CODE_S_OK;
 }
 
-int vfs_read(id_cap_t fd, char* buffer, std::streamsize size, std::streamsize& act_size) {
+int vfs_read(id_cap_t fd, char* buffer, std::streamsize size, std::streamsize& act_size, endpoint_cap_t& wait_ep) {
   if (dir_streams.contains(fd)) {
     if (size < static_cast<std::streamsize>(sizeof(fs_file_info))) [[unlikely]] {
       return FS_CODE_E_ILL_ARGS;
@@ -197,9 +301,9 @@ int vfs_read(id_cap_t fd, char* buffer, std::streamsize size, std::streamsize& a
     return FS_CODE_E_NO_SUCH_FILE;
   }
 
-  act_size = mnt->get().read(fd, buffer, size);
+  act_size = mnt->get().read(fd, buffer, size, wait_ep);
   if (act_size < 0) {
-    return FS_CODE_E_FAILURE;
+    return errno == FS_CODE_E_AGAIN ? FS_CODE_E_AGAIN : FS_CODE_E_FAILURE;
   }
 
   return FS_CODE_S_OK;
@@ -245,3 +349,170 @@ int vfs_tell(id_cap_t fd, std::streampos& dst) {
 
   return FS_CODE_S_OK;
 }
+
+int vfs_mmap(id_cap_t fd, std::streamoff offset, size_t size, id_cap_t& ticket, size_t& act_size) {
+  if (dir_streams.contains(fd)) [[unlikely]] {
+    return FS_CODE_E_TYPE;
+  }
+
+  auto mnt = mount_point::find_mount_point(fd);
+  if (!mnt) {
+    return FS_CODE_E_NO_SUCH_FILE;
+  }
+
+  ticket = mnt->get().mmap(fd, offset, size, act_size);
+  if (ticket == 0) {
+    return errno;
+  }
+
+  return FS_CODE_S_OK;
+}
+
+int vfs_truncate(id_cap_t fd, std::streamsize size) {
+  if (dir_streams.contains(fd)) [[unlikely]] {
+    return FS_CODE_E_TYPE;
+  }
+
+  auto mnt = mount_point::find_mount_point(fd);
+  if (!mnt) {
+    return FS_CODE_E_NO_SUCH_FILE;
+  }
+
+  if (!mnt->get().truncate(fd, size)) {
+    return errno;
+  }
+
+  return FS_CODE_S_OK;
+}
+
+int vfs_readdir(id_cap_t fd, char* buffer, std::streamsize size, std::streamsize& act_size) {
+  if (dir_streams.contains(fd)) {
+    if (size < static_cast<std::streamsize>(FS_DIRENT_SIZE(FS_FILE_NAME_SIZE_MAX))) [[unlikely]] {
+      return FS_CODE_E_ILL_ARGS;
+    }
+
+    act_size = dir_streams.at(fd).readdir(buffer, size);
+
+    if (act_size == 0) [[unlikely]] {
+      return FS_CODE_E_EOF;
+    }
+
+    return FS_CODE_S_OK;
+  }
+
+  auto mnt = mount_point::find_mount_point(fd);
+  if (!mnt) {
+    return FS_CODE_E_NO_SUCH_FILE;
+  }
+
+  act_size = mnt->get().readdir(fd, buffer, size);
+  if (act_size < 0) {
+    return errno;
+  }
+
+  return FS_CODE_S_OK;
+}
+
+int vfs_pread(id_cap_t fd, std::streampos pos, char* buffer, std::streamsize size, std::streamsize& act_size) {
+  if (dir_streams.contains(fd)) [[unlikely]] {
+    return FS_CODE_E_TYPE;
+  }
+
+  auto mnt = mount_point::find_mount_point(fd);
+  if (!mnt) {
+    return FS_CODE_E_NO_SUCH_FILE;
+  }
+
+  act_size = mnt->get().pread(fd, pos, buffer, size);
+  if (act_size < 0) {
+    return errno;
+  }
+
+  return FS_CODE_S_OK;
+}
+
+int vfs_pwrite(id_cap_t fd, std::streampos pos, std::string_view data, std::streamsize& act_size) {
+  if (dir_streams.contains(fd)) [[unlikely]] {
+    return FS_CODE_E_TYPE;
+  }
+
+  auto mnt = mount_point::find_mount_point(fd);
+  if (!mnt) {
+    return FS_CODE_E_NO_SUCH_FILE;
+  }
+
+  act_size = mnt->get().pwrite(fd, pos, data);
+  if (act_size < 0) {
+    return errno;
+  }
+
+  return FS_CODE_S_OK;
+}
+
+int vfs_preadv(id_cap_t fd, const fs_iovec* iov, size_t count, char* buffer, std::streamsize* act_sizes) {
+  if (dir_streams.contains(fd)) [[unlikely]] {
+    return FS_CODE_E_TYPE;
+  }
+
+  auto mnt = mount_point::find_mount_point(fd);
+  if (!mnt) {
+    return FS_CODE_E_NO_SUCH_FILE;
+  }
+
+  if (!mnt->get().preadv(fd, iov, count, buffer, act_sizes)) {
+    return errno;
+  }
+
+  return FS_CODE_S_OK;
+}
+
+int vfs_pwritev(id_cap_t fd, const fs_iovec* iov, size_t count, std::string_view data, std::streamsize& act_size) {
+  if (dir_streams.contains(fd)) [[unlikely]] {
+    return FS_CODE_E_TYPE;
+  }
+
+  auto mnt = mount_point::find_mount_point(fd);
+  if (!mnt) {
+    return FS_CODE_E_NO_SUCH_FILE;
+  }
+
+  act_size = mnt->get().pwritev(fd, iov, count, data.data(), data.size());
+  if (act_size < 0) {
+    return errno;
+  }
+
+  return FS_CODE_S_OK;
+}
+
+int vfs_readfile(std::string_view path, char* buffer, std::streamsize size, std::streamsize& act_size, size_t& file_size) {
+  if (path.empty() || path.front() != '/') [[unlikely]] {
+    return FS_CODE_E_NO_SUCH_FILE;
+  }
+
+  path.remove_prefix(1);
+
+  resolved_path& entry = resolve(path);
+
+  if (entry.missing) {
+    return FS_CODE_E_NO_SUCH_FILE;
+  }
+
+  if (entry.mnt_dir != nullptr) {
+    act_size = entry.mnt_dir->readfile(get_subpath(path, entry), buffer, size, file_size);
+
+    if (act_size < 0) [[unlikely]] {
+      if (errno == FS_CODE_E_NO_SUCH_FILE) {
+        remember_missing(entry);
+      }
+      return errno;
+    }
+
+    return FS_CODE_S_OK;
+  }
+
+  if (entry.dir != nullptr) {
+    return FS_CODE_E_TYPE;
+  }
+
+  return FS_CODE_E_NO_SUCH_FILE;
+}
@@ -18,7 +18,7 @@ typedef struct {
 } task_context_t;
 
 typedef mem_cap_t (*mem_cap_fetcher_t)(size_t size, size_t alignment);
-typedef void (*vmapper_t)(task_context_t* ctx, int flags, uintptr_t va, const void* data);
+typedef void (*vmapper_t)(task_context_t* ctx, int flags, uintptr_t va, size_t size, const void* data, size_t data_size);
 
 bool create_task(task_context_t* ctx, mem_cap_fetcher_t fetch_mem_cap);
 bool load_elf(task_context_t* ctx, const void* elf_data, size_t elf_size, vmapper_t vmap);
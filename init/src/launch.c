@@ -60,7 +60,17 @@ static mem_cap_t early_fetch_mem_cap(size_t size, size_t alignment) {
   return root_boot_info->caps[root_boot_info->mem_caps_offset + index];
 }
 
-static void early_vmap(task_context_t* ctx, int flags, uintptr_t va, const void* data) {
+static void copy_page_data(void* page, uintptr_t page_va, uintptr_t data_va, const void* data, size_t data_size) {
+  uintptr_t start = page_va > data_va ? page_va : data_va;
+  uintptr_t end   = page_va + KILO_PAGE_SIZE < data_va + data_size ? page_va + KILO_PAGE_SIZE : data_va + data_size;
+
+  memset(page, 0, KILO_PAGE_SIZE);
+  if (start < end) {
+    memcpy((char*)page + (start - page_va), (const char*)data + (start - data_va), end - start);
+  }
+}
+
+static void early_vmap_page(task_context_t* ctx, int flags, uintptr_t va, uintptr_t data_va, const void* data, size_t data_size) {
   const size_t page_table_size  = unwrap_sysret(sys_system_cap_size(CAP_PAGE_TABLE));
   const size_t page_table_align = unwrap_sysret(sys_system_cap_align(CAP_PAGE_TABLE));
 
@@ -116,11 +126,24 @@ static void early_vmap(task_context_t* ctx, int flags, uintptr_t va, const void*
     unwrap_sysret(sys_page_table_cap_map_page(page_table_cap, get_page_table_index(va, KILO_PAGE), readable, writable, executable, virt_page_cap));
   } else {
     unwrap_sysret(sys_page_table_cap_map_page(root_boot_info->page_table_caps[KILO_PAGE], get_page_table_index(root_boot_info->root_task_end_address, KILO_PAGE), true, true, false, virt_page_cap));
-    memcpy((void*)root_boot_info->root_task_end_address, data, KILO_PAGE_SIZE);
+    copy_page_data((void*)root_boot_info->root_task_end_address, va, data_va, data, data_size);
     unwrap_sysret(sys_page_table_cap_remap_page(page_table_cap, get_page_table_index(va, KILO_PAGE), readable, writable, executable, virt_page_cap, root_boot_info->page_table_caps[KILO_PAGE]));
   }
 }
 
+static void early_vmap(task_context_t* ctx, int flags, uintptr_t va, size_t size, const void* data, size_t data_size) {
+  uintptr_t va_start = va / KILO_PAGE_SIZE * KILO_PAGE_SIZE;
+  uintptr_t va_end   = (va + size + KILO_PAGE_SIZE - 1) / KILO_PAGE_SIZE * KILO_PAGE_SIZE;
+
+  for (uintptr_t page_va = va_start; page_va < va_end; page_va += KILO_PAGE_SIZE) {
+    if (data != NULL && page_va < va + data_size) {
+      early_vmap_page(ctx, flags, page_va, va, data, data_size);
+    } else {
+      early_vmap_page(ctx, flags, page_va, va, NULL, 0);
+    }
+  }
+}
+
 static endpoint_cap_t early_create_ep_cap() {
   mem_cap_t ep_mem_cap = early_fetch_mem_cap(unwrap_sysret(sys_system_cap_size(CAP_ENDPOINT)), unwrap_sysret(sys_system_cap_align(CAP_ENDPOINT)));
   __if_unlikely (ep_mem_cap == 0) {
@@ -129,20 +152,28 @@ static endpoint_cap_t early_create_ep_cap() {
   return unwrap_sysret(sys_mem_cap_create_endpoint_object(ep_mem_cap));
 }
 
-static void vmap(task_context_t* ctx, int flags, uintptr_t va, const void* data) {
-  if (data == NULL) {
-    __if_unlikely (mm_vmap(ctx->mm_id_cap, KILO_PAGE, flags, va) == 0) {
-      abort();
-    }
-  } else {
-    root_boot_info_t* root_boot_info = (root_boot_info_t*)__init_context.__arg_regs[0];
+static void vmap(task_context_t* ctx, int flags, uintptr_t va, size_t size, const void* data, size_t data_size) {
+  uintptr_t va_start = va / KILO_PAGE_SIZE * KILO_PAGE_SIZE;
+  uintptr_t va_end   = (va + size + KILO_PAGE_SIZE - 1) / KILO_PAGE_SIZE * KILO_PAGE_SIZE;
+  uintptr_t data_end = va_start;
+
+  if (data != NULL && data_size > 0) {
+    data_end = (va + data_size + KILO_PAGE_SIZE - 1) / KILO_PAGE_SIZE * KILO_PAGE_SIZE;
 
-    uintptr_t src_va = mm_vmap(__mm_id_cap, KILO_PAGE, flags | MM_VMAP_FLAG_WRITE, root_boot_info->root_task_end_address);
+    // mm keeps the range around the init image reserved, so the staging range is placed by mm.
+    uintptr_t src_va = mm_vmap_range(__mm_id_cap, KILO_PAGE, flags | MM_VMAP_FLAG_WRITE, MM_VA_RAMDOM, data_end - va_start, 0, 0);
     __if_unlikely (src_va == 0) {
       abort();
     }
-    memcpy((void*)src_va, data, KILO_PAGE_SIZE);
-    __if_unlikely (mm_vremap(__mm_id_cap, ctx->mm_id_cap, flags, src_va, va) == 0) {
+    memset((void*)src_va, 0, data_end - va_start);
+    memcpy((void*)(src_va + (va - va_start)), data, data_size);
+    __if_unlikely (mm_vmap_range(ctx->mm_id_cap, KILO_PAGE, flags, va_start, data_end - va_start, __mm_id_cap, src_va) == 0) {
+      abort();
+    }
+  }
+
+  if (data_end < va_end) {
+    __if_unlikely (mm_vmap_range(ctx->mm_id_cap, get_max_page(), flags, data_end, va_end - data_end, 0, 0) == 0) {
       abort();
     }
   }
@@ -280,7 +311,8 @@ void launch_mm(task_context_t* ctx) {
     abort();
   }
 
-  void* heap_start = __heap_sbrk();
+  size_t heap_size  = KILO_PAGE_SIZE;
+  void*  heap_start = __heap_sbrk(&heap_size);
 
   __if_unlikely (heap_start == NULL) {
     abort();
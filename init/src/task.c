@@ -122,8 +122,6 @@ static bool is_valid_elf_format(const void* data, size_t size) {
 }
 
 bool load_elf(task_context_t* ctx, const void* elf_data, size_t elf_size, vmapper_t vmap) {
-  static char buf[KILO_PAGE_SIZE];
-
   if (!is_valid_elf_format(elf_data, elf_size)) {
     return false;
   }
@@ -152,9 +150,7 @@ bool load_elf(task_context_t* ctx, const void* elf_data, size_t elf_size, vmappe
     bool writable   = (program_headers[i].flags & ELF_PH_FLAG_WRITABLE) != 0;
     bool executable = (program_headers[i].flags & ELF_PH_FLAG_EXECUTABLE) != 0;
 
-    uintptr_t va_start  = program_headers[i].virtual_address / KILO_PAGE_SIZE * KILO_PAGE_SIZE;
-    uintptr_t va_end    = (program_headers[i].virtual_address + program_headers[i].memory_size + KILO_PAGE_SIZE - 1) / KILO_PAGE_SIZE * KILO_PAGE_SIZE;
-    size_t    va_offset = program_headers[i].virtual_address % KILO_PAGE_SIZE;
+    uintptr_t va_end = (program_headers[i].virtual_address + program_headers[i].memory_size + KILO_PAGE_SIZE - 1) / KILO_PAGE_SIZE * KILO_PAGE_SIZE;
 
     const char* section_data = (const char*)elf_data + program_headers[i].offset;
 
@@ -169,25 +165,7 @@ bool load_elf(task_context_t* ctx, const void* elf_data, size_t elf_size, vmappe
       flags |= MM_VMAP_FLAG_EXEC;
     }
 
-    for (uintptr_t va = va_start; va < va_end; va += KILO_PAGE_SIZE) {
-      size_t offset = va - va_start;
-
-      if (offset < (program_headers[i].file_size + va_offset)) {
-        size_t interval_start = va == va_start ? va_offset : 0;
-        size_t interval_end   = KILO_PAGE_SIZE;
-
-        if (offset + interval_end > (program_headers[i].file_size + va_offset)) {
-          interval_end = (program_headers[i].file_size + va_offset) - offset;
-        }
-
-        memset(buf, 0, interval_start);
-        memcpy(buf + interval_start, section_data + offset, interval_end - interval_start);
-        memset(buf + interval_end, 0, KILO_PAGE_SIZE - interval_end);
-        vmap(ctx, flags, va, buf);
-      } else {
-        vmap(ctx, flags, va, NULL);
-      }
-    }
+    vmap(ctx, flags, program_headers[i].virtual_address, program_headers[i].memory_size, section_data, program_headers[i].file_size);
 
     if (ctx->heap_root < va_end) {
       ctx->heap_root = va_end;
@@ -203,7 +181,7 @@ bool load_elf(task_context_t* ctx, const void* elf_data, size_t elf_size, vmappe
 
 bool alloc_stack(task_context_t* ctx, vmapper_t vmap) {
   const uintptr_t stack_va = unwrap_sysret(sys_system_user_space_end()) - KILO_PAGE_SIZE;
-  vmap(ctx, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, stack_va, NULL);
+  vmap(ctx, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, stack_va, KILO_PAGE_SIZE, NULL, 0);
   unwrap_sysret(sys_task_cap_set_reg(ctx->task_cap, REG_STACK_POINTER, stack_va + KILO_PAGE_SIZE));
   return true;
 }
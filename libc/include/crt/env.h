@@ -0,0 +1,21 @@
+#ifndef LIBC_CRT_ENV_H_
+#define LIBC_CRT_ENV_H_
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+  extern char** __environ;
+
+  bool  __env_init(char** envp);
+  char* __env_get(const char* name);
+  bool  __env_set(const char* name, const char* value, bool overwrite);
+  void  __env_sync();
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIBC_CRT_ENV_H_
@@ -9,8 +9,12 @@ extern "C" {
 
   void  __heap_init();
   void* __heap_alloc(size_t size);
+  void* __heap_alloc_aligned(size_t size, size_t alignment);
+  void* __heap_realloc(void* ptr, size_t size, size_t alignment);
   void  __heap_free(void* ptr);
-  void* __heap_sbrk();
+  void* __heap_sbrk(size_t* size);
+  void* __heap_map(size_t size);
+  void  __heap_unmap(void* ptr, size_t size);
 
 #ifdef __cplusplus
 } // extern "C"
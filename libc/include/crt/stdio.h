@@ -0,0 +1,14 @@
+#ifndef LIBC_CRT_STDIO_H_
+#define LIBC_CRT_STDIO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+  void __stdio_flush_all();
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIBC_CRT_STDIO_H_
@@ -1,11 +1,14 @@
 #ifndef LIBC_DIRENT_H_
 #define LIBC_DIRENT_H_
 
+#include <fs/ipc.h>
 #include <libcaprese/cap.h>
+#include <stddef.h>
 
 #define DT_UNKNOWN 0
 #define DT_DIR     1
 #define DT_REG     2
+#define DT_CHR     3
 
 typedef uint32_t ino_t;
 
@@ -15,8 +18,12 @@ struct dirent {
   char          d_name[256];
 };
 
+// Entries are fetched from the fs in batches and served from buf.
 typedef struct {
   id_cap_t      fd;
+  size_t        buf_pos;
+  size_t        buf_size;
+  char          buf[FS_READ_MAX_SIZE];
   struct dirent entry;
 } DIR;
 
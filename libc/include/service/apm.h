@@ -15,6 +15,7 @@ extern "C" {
   bool           apm_setenv(task_cap_t task_cap, const char* env, const char* value);
   bool           apm_getenv(task_cap_t task_cap, const char* env, char* value, size_t* value_size);
   bool           apm_nextenv(task_cap_t task_cap, const char* env, char* value, size_t* value_size);
+  bool           apm_dumpenv(task_cap_t task_cap, char* buf, size_t* buf_size);
 
 #ifdef __cplusplus
 } // extern "C"
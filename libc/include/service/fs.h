@@ -11,18 +11,28 @@
 extern "C" {
 #endif // __cplusplus
 
-  id_cap_t fs_mount(endpoint_cap_t ep_cap, const char* root_path);
-  void     fs_unmount(id_cap_t id_cap);
-  bool     fs_mounted(const char* root_path);
-  bool     fs_info(const char* path, struct fs_file_info* dst);
-  bool     fs_create(const char* path, int type);
-  bool     fs_remove(const char* path);
-  id_cap_t fs_open(const char* path);
-  void     fs_close(id_cap_t fd);
-  ssize_t  fs_read(id_cap_t fd, void* buf, size_t count);
-  ssize_t  fs_write(id_cap_t fd, const void* buf, size_t count);
-  bool     fs_seek(id_cap_t fd, intptr_t offset, int whence);
-  intptr_t fs_tell(id_cap_t fd);
+  id_cap_t    fs_mount(endpoint_cap_t ep_cap, const char* root_path);
+  void        fs_unmount(id_cap_t id_cap);
+  bool        fs_mounted(const char* root_path);
+  bool        fs_info(const char* path, struct fs_file_info* dst);
+  bool        fs_create(const char* path, int type);
+  bool        fs_remove(const char* path);
+  id_cap_t    fs_open(const char* path);
+  id_cap_t    fs_open_info(const char* path, struct fs_file_info* info);
+  void        fs_close(id_cap_t fd);
+  ssize_t     fs_read(id_cap_t fd, void* buf, size_t count);
+  ssize_t     fs_write(id_cap_t fd, const void* buf, size_t count);
+  bool        fs_seek(id_cap_t fd, intptr_t offset, int whence);
+  intptr_t    fs_tell(id_cap_t fd);
+  const void* fs_mmap(id_cap_t fd, size_t offset, size_t size, size_t* act_size);
+  bool        fs_munmap(const void* addr, size_t size);
+  bool        fs_truncate(id_cap_t fd, size_t size);
+  ssize_t     fs_readdir(id_cap_t fd, void* buf, size_t count);
+  ssize_t     fs_pread(id_cap_t fd, void* buf, size_t count, size_t offset);
+  ssize_t     fs_pwrite(id_cap_t fd, const void* buf, size_t count, size_t offset);
+  ssize_t     fs_preadv(id_cap_t fd, const struct fs_iovec* iov, size_t iovcnt, void* buf, size_t* act_sizes);
+  ssize_t     fs_pwritev(id_cap_t fd, const struct fs_iovec* iov, size_t iovcnt, const void* buf);
+  ssize_t     fs_readfile(const char* path, void* buf, size_t count, size_t* file_size);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -16,6 +16,10 @@ extern "C" {
   uintptr_t mm_vremap(id_cap_t src_id_cap, id_cap_t dst_id_cap, int flags, uintptr_t src_va_base, uintptr_t dst_va_base);
   uintptr_t mm_vpmap(id_cap_t id_cap, int flags, virt_page_cap_t virt_page_cap, uintptr_t va_base);
   uintptr_t mm_vpremap(id_cap_t src_id_cap, id_cap_t dst_id_cap, int flags, virt_page_cap_t virt_page_cap, uintptr_t va_base);
+  uintptr_t mm_vmap_range(id_cap_t id_cap, int max_level, int flags, uintptr_t va_base, size_t size, id_cap_t src_id_cap, uintptr_t src_va_base);
+  bool      mm_vunmap(id_cap_t id_cap, uintptr_t va_base, size_t size);
+  id_cap_t  mm_vgive(id_cap_t id_cap, uintptr_t va_base, size_t size);
+  uintptr_t mm_vtake(id_cap_t id_cap, id_cap_t ticket, int flags, uintptr_t va_base, size_t* act_size);
 
   mem_cap_t mm_fetch(size_t size, size_t alignment);
   bool      mm_revoke(mem_cap_t mem_cap);
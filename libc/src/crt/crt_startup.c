@@ -1,5 +1,7 @@
+#include <crt/env.h>
 #include <crt/global.h>
 #include <crt/heap.h>
+#include <crt/stdio.h>
 #include <internal/branch.h>
 #include <libcaprese/cap.h>
 #include <service/apm.h>
@@ -10,6 +12,8 @@ void __crt_cleanup() {
   for (void (**destructor)() = __fini_array_start; destructor != __fini_array_end; ++destructor) {
     (*destructor)();
   }
+
+  __stdio_flush_all();
 }
 
 int __crt_startup() {
@@ -24,13 +28,18 @@ int __crt_startup() {
   }
 
   if (__apm_ep_cap != 0 && __mm_id_cap != 0) {
-    void* heap_start = __heap_sbrk();
+    size_t heap_size  = KILO_PAGE_SIZE;
+    void*  heap_start = __heap_sbrk(&heap_size);
     __if_unlikely (heap_start == NULL) {
       return 1;
     }
     __brk_start = (uintptr_t)heap_start;
     __heap_init();
 
+    __if_unlikely (!__env_init((char**)__init_context.__arg_regs[7])) {
+      return 1;
+    }
+
     __fs_ep_cap = apm_lookup("fs");
     __if_unlikely (unwrap_sysret(sys_cap_same(__this_ep_cap, __fs_ep_cap))) {
       sys_cap_destroy(__fs_ep_cap);
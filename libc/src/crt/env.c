@@ -0,0 +1,229 @@
+#include <crt/env.h>
+#include <crt/global.h>
+#include <internal/branch.h>
+#include <service/apm.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The environment is kept locally as "NAME=VALUE" strings in __environ, indexed by an open-addressing hash table.
+// The strings apm places on the initial stack are used as they are. Strings set later are owned by the table and
+// marked dirty until they are pushed to apm, which happens right before a child task is created.
+
+#define __ENV_OWNED ((uint8_t)1 << 0)
+#define __ENV_DIRTY ((uint8_t)1 << 1)
+
+struct __env_slot {
+  size_t hash;
+  size_t index;
+};
+
+static char* __env_empty[] = { NULL };
+
+char** __environ = __env_empty;
+
+static uint8_t*           __env_flags;
+static size_t             __env_count;
+static size_t             __env_capacity;
+static struct __env_slot* __env_slots;
+static size_t             __env_num_slots;
+static bool               __env_dirty;
+
+static size_t __env_name_len(const char* str) {
+  const char* eq = strchr(str, '=');
+  return eq != NULL ? (size_t)(eq - str) : strlen(str);
+}
+
+static size_t __env_hash(const char* name, size_t len) {
+  size_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < len; ++i) {
+    hash = (hash ^ (unsigned char)name[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+// Returns the slot of the variable, or the empty slot where it would go.
+static struct __env_slot* __env_lookup(const char* name, size_t len, size_t hash) {
+  for (size_t i = hash & (__env_num_slots - 1);; i = (i + 1) & (__env_num_slots - 1)) {
+    struct __env_slot* slot = &__env_slots[i];
+    if (slot->index == 0) {
+      return slot;
+    }
+    if (slot->hash == hash) {
+      const char* str = __environ[slot->index - 1];
+      if (strncmp(str, name, len) == 0 && str[len] == '=') {
+        return slot;
+      }
+    }
+  }
+}
+
+static bool __env_reserve(size_t count) {
+  if (count + 1 > __env_capacity) {
+    size_t capacity = __env_capacity < 8 ? 8 : __env_capacity * 2;
+    while (capacity < count + 1) {
+      capacity *= 2;
+    }
+
+    char**   entries = realloc(__environ == __env_empty ? NULL : __environ, sizeof(char*) * capacity);
+    uint8_t* flags   = NULL;
+    if (entries != NULL) {
+      __environ = entries;
+      flags     = realloc(__env_flags, capacity);
+    }
+    __if_unlikely (flags == NULL) {
+      return false;
+    }
+
+    __env_flags    = flags;
+    __env_capacity = capacity;
+  }
+
+  // Keep the table at most half full.
+  if (count * 2 > __env_num_slots) {
+    size_t num_slots = __env_num_slots < 16 ? 16 : __env_num_slots;
+    while (count * 2 > num_slots) {
+      num_slots *= 2;
+    }
+
+    struct __env_slot* slots = calloc(num_slots, sizeof(struct __env_slot));
+    __if_unlikely (slots == NULL) {
+      return false;
+    }
+
+    struct __env_slot* old_slots     = __env_slots;
+    size_t             old_num_slots = __env_num_slots;
+
+    __env_slots     = slots;
+    __env_num_slots = num_slots;
+
+    for (size_t i = 0; i < old_num_slots; ++i) {
+      if (old_slots[i].index != 0) {
+        for (size_t j = old_slots[i].hash & (num_slots - 1);; j = (j + 1) & (num_slots - 1)) {
+          if (slots[j].index == 0) {
+            slots[j] = old_slots[i];
+            break;
+          }
+        }
+      }
+    }
+
+    free(old_slots);
+  }
+
+  return true;
+}
+
+static bool __env_put(char* str, uint8_t flags) {
+  size_t len  = __env_name_len(str);
+  size_t hash = __env_hash(str, len);
+
+  __if_unlikely (!__env_reserve(__env_count + 1)) {
+    return false;
+  }
+
+  struct __env_slot* slot = __env_lookup(str, len, hash);
+  if (slot->index != 0) {
+    if (__env_flags[slot->index - 1] & __ENV_OWNED) {
+      free(__environ[slot->index - 1]);
+    }
+    __environ[slot->index - 1]   = str;
+    __env_flags[slot->index - 1] = flags;
+    return true;
+  }
+
+  __environ[__env_count]   = str;
+  __env_flags[__env_count] = flags;
+  __environ[++__env_count] = NULL;
+  slot->hash               = hash;
+  slot->index              = __env_count;
+
+  return true;
+}
+
+bool __env_init(char** envp) {
+  if (envp == NULL) {
+    return true;
+  }
+
+  size_t count = 0;
+  while (envp[count] != NULL) {
+    ++count;
+  }
+
+  __if_unlikely (!__env_reserve(count)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    __if_unlikely (!__env_put(envp[i], 0)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+char* __env_get(const char* name) {
+  if (__env_count == 0) {
+    return NULL;
+  }
+
+  size_t             len  = strlen(name);
+  struct __env_slot* slot = __env_lookup(name, len, __env_hash(name, len));
+  if (slot->index == 0) {
+    return NULL;
+  }
+
+  return __environ[slot->index - 1] + len + 1;
+}
+
+bool __env_set(const char* name, const char* value, bool overwrite) {
+  size_t name_len = strlen(name);
+  __if_unlikely (name_len == 0 || memchr(name, '=', name_len) != NULL) {
+    return false;
+  }
+
+  if (!overwrite && __env_get(name) != NULL) {
+    return true;
+  }
+
+  size_t value_len = strlen(value);
+  char*  str       = malloc(name_len + value_len + 2);
+  __if_unlikely (str == NULL) {
+    return false;
+  }
+
+  memcpy(str, name, name_len);
+  str[name_len] = '=';
+  memcpy(str + name_len + 1, value, value_len + 1);
+
+  __if_unlikely (!__env_put(str, __ENV_OWNED | __ENV_DIRTY)) {
+    free(str);
+    return false;
+  }
+
+  __env_dirty = true;
+
+  return true;
+}
+
+void __env_sync() {
+  if (!__env_dirty) {
+    return;
+  }
+
+  for (size_t i = 0; i < __env_count; ++i) {
+    if (__env_flags[i] & __ENV_DIRTY) {
+      // Dirty strings are owned, so the separator can be cut for the duration of the call.
+      char* eq = __environ[i] + __env_name_len(__environ[i]);
+      *eq      = '\0';
+      apm_setenv(__this_task_cap, __environ[i], eq + 1);
+      *eq = '=';
+
+      __env_flags[i] &= ~__ENV_DIRTY;
+    }
+  }
+
+  __env_dirty = false;
+}
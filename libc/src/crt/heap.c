@@ -6,30 +6,519 @@
 #include <libcaprese/syscall.h>
 #include <service/mm.h>
 #include <stdalign.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
-typedef struct __heap_block_header {
-  struct __heap_block_header* next;
-  size_t                      size;
-} __heap_block_header_t;
+// Small requests are served from per-size-class slabs, requests above the map threshold get pages of their own
+// from mm, and everything in between comes from boundary-tagged blocks.
+//
+// Every allocation is preceded by a one-word header. For a block it holds the block size and flags, and a free
+// block repeats its size in its last word so that a freed neighbour can find it. For a slab slot it holds the
+// distance back to the slab header, and for a mapped allocation the mapping size, with the mapping base in the word
+// before it. Free blocks are kept in power-of-two bins, with a bitmap of the non-empty ones. The slots of a
+// power-of-two class are aligned to the stride, which is how over-aligned small requests are served.
+//
+// Each region ends with a fence that records where the region starts, so a region whose memory has been freed
+// entirely can be handed back to mm. One such idle region is kept mapped so that the heap does not thrash at the edge.
+// Memory that sbrk maps right behind the last region extends it instead of starting a new one.
 
-__heap_block_header_t* __heap_block_free_list;
+#define __HEAP_ALIGN          alignof(max_align_t)
+#define __HEAP_WORD           sizeof(size_t)
+#define __HEAP_IN_USE         ((size_t)1 << 0)
+#define __HEAP_PREV_IN_USE    ((size_t)1 << 1)
+#define __HEAP_SLAB           ((size_t)1 << 2)
+#define __HEAP_MAPPED         ((size_t)1 << 3)
+#define __HEAP_FLAGS          (__HEAP_IN_USE | __HEAP_PREV_IN_USE | __HEAP_SLAB | __HEAP_MAPPED)
+#define __HEAP_MIN_BLOCK      (__HEAP_ALIGN * 2)
+#define __HEAP_NUM_BINS       (sizeof(size_t) * 8)
+#define __HEAP_FENCE_SIZE     (__HEAP_ALIGN + __HEAP_WORD)
+#define __HEAP_SMALL_SLAB     (0x1000 - __HEAP_ALIGN * 2)
+#define __HEAP_LARGE_SLAB     (0x4000 - __HEAP_ALIGN * 2)
+#define __HEAP_SLAB_SPLIT     256
+#define __HEAP_MAX_STRIDE     1024
+#define __HEAP_MAP_THRESHOLD  0x40000
+#define __HEAP_MEGA_THRESHOLD 0x80000
+#define __HEAP_NUM_CLASSES    (sizeof(__heap_strides) / sizeof(__heap_strides[0]))
+#define __HEAP_SMALL_MAX      (__heap_strides[__HEAP_NUM_CLASSES - 1] - __HEAP_WORD)
+#define __HEAP_ROUND_UP(x)    (((x) + __HEAP_ALIGN - 1) / __HEAP_ALIGN * __HEAP_ALIGN)
 
-static void __heap_split(__heap_block_header_t* header, size_t size) {
-  if (header->size - size >= sizeof(__heap_block_header_t) + alignof(max_align_t)) {
-    __heap_block_header_t* new_header = (__heap_block_header_t*)((uintptr_t)(header + 1) + size);
-    new_header->next                  = header->next;
-    new_header->size                  = header->size - size - sizeof(__heap_block_header_t);
-    header->next                      = new_header;
-    header->size                      = size;
+typedef struct __heap_block {
+  size_t               head;
+  struct __heap_block* next;
+  struct __heap_block* prev;
+} __heap_block_t;
+
+typedef struct __heap_slab {
+  struct __heap_slab* next;
+  struct __heap_slab* prev;
+  void*               free_list;
+  size_t              cls;
+  size_t              num_used;
+  size_t              num_carved;
+  size_t              num_slots;
+} __heap_slab_t;
+
+static const size_t __heap_strides[] = { 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, __HEAP_MAX_STRIDE };
+
+static __heap_block_t* __heap_bins[__HEAP_NUM_BINS];
+static size_t          __heap_bin_map;
+static __heap_slab_t*  __heap_partial_slabs[__HEAP_NUM_CLASSES];
+static uint8_t         __heap_class_of[__HEAP_MAX_STRIDE / __HEAP_ALIGN + 1];
+static uintptr_t       __heap_idle_region;
+static __heap_block_t* __heap_last_fence;
+static size_t          __heap_sbrk_size;
+
+static size_t __heap_block_size(const __heap_block_t* block) {
+  return block->head & ~__HEAP_FLAGS;
+}
+
+static __heap_block_t* __heap_next_block(const __heap_block_t* block) {
+  return (__heap_block_t*)((uintptr_t)block + __heap_block_size(block));
+}
+
+// The block size that holds `size` bytes of payload, or 0 on overflow. A block never gets smaller than
+// __HEAP_MIN_BLOCK, since it has to hold the free list links and the trailing size once it is freed.
+static size_t __heap_block_size_for(size_t size) {
+  size_t block_size = __HEAP_ROUND_UP(size + __HEAP_WORD);
+  if (block_size < size) {
+    return 0;
+  }
+  return block_size < __HEAP_MIN_BLOCK ? __HEAP_MIN_BLOCK : block_size;
+}
+
+static size_t __heap_bin_index(size_t size) {
+  return sizeof(size_t) * 8 - 1 - __builtin_clzl(size);
+}
+
+static void __heap_insert_block(__heap_block_t* block) {
+  size_t index = __heap_bin_index(__heap_block_size(block));
+
+  block->prev = NULL;
+  block->next = __heap_bins[index];
+  if (block->next != NULL) {
+    block->next->prev = block;
+  }
+  __heap_bins[index]  = block;
+  __heap_bin_map     |= (size_t)1 << index;
+}
+
+static void __heap_remove_block(__heap_block_t* block) {
+  size_t index = __heap_bin_index(__heap_block_size(block));
+
+  if (block->prev != NULL) {
+    block->prev->next = block->next;
+  } else {
+    __heap_bins[index] = block->next;
+    if (block->next == NULL) {
+      __heap_bin_map &= ~((size_t)1 << index);
+    }
+  }
+  if (block->next != NULL) {
+    block->next->prev = block->prev;
+  }
+}
+
+// Marks the block free with the given size, keeping its PREV_IN_USE bit, and tells the next block about it.
+static void __heap_set_free(__heap_block_t* block, size_t size) {
+  block->head                                        = size | (block->head & __HEAP_PREV_IN_USE);
+  *(size_t*)((uintptr_t)block + size - __HEAP_WORD)  = size;
+  __heap_next_block(block)->head                    &= ~__HEAP_PREV_IN_USE;
+}
+
+static void __heap_add_region(void* start, size_t size) {
+  // The first block starts one word in so that payloads are aligned, and a zero-sized fence closes the region.
+  __heap_block_t* block = (__heap_block_t*)((uintptr_t)start + __HEAP_ALIGN - __HEAP_WORD);
+  size_t          body  = (size - __HEAP_ALIGN * 2) / __HEAP_ALIGN * __HEAP_ALIGN;
+  __heap_block_t* fence = (__heap_block_t*)((uintptr_t)block + body);
+
+  fence->head = __HEAP_IN_USE;
+  fence->next = (__heap_block_t*)start;
+  block->head = body | __HEAP_PREV_IN_USE;
+  __heap_set_free(block, body);
+  __heap_insert_block(block);
+
+  __heap_last_fence = fence;
+}
+
+static __heap_block_t* __heap_find_block(size_t size) {
+  size_t index = __heap_bin_index(size);
+
+  if (__heap_bin_map & ((size_t)1 << index)) {
+    for (__heap_block_t* block = __heap_bins[index]; block != NULL; block = block->next) {
+      if (__heap_block_size(block) >= size) {
+        return block;
+      }
+    }
+  }
+
+  // Every block in a higher bin is large enough.
+  size_t map = index + 1 < __HEAP_NUM_BINS ? __heap_bin_map & ~(((size_t)1 << (index + 1)) - 1) : 0;
+  if (map != 0) {
+    return __heap_bins[__builtin_ctzl(map)];
+  }
+
+  return NULL;
+}
+
+static __heap_block_t* __heap_free_block(__heap_block_t* block) {
+  size_t          size = __heap_block_size(block);
+  __heap_block_t* next = __heap_next_block(block);
+
+  if ((next->head & __HEAP_IN_USE) == 0) {
+    __heap_remove_block(next);
+    size += __heap_block_size(next);
   }
+
+  if ((block->head & __HEAP_PREV_IN_USE) == 0) {
+    size_t          prev_size = *(size_t*)((uintptr_t)block - __HEAP_WORD);
+    __heap_block_t* prev      = (__heap_block_t*)((uintptr_t)block - prev_size);
+    __heap_remove_block(prev);
+    size  += prev_size;
+    block  = prev;
+  }
+
+  __heap_set_free(block, size);
+  __heap_insert_block(block);
+
+  return block;
+}
+
+// Turns the fence of the last region and the memory mapped right after it into a free block, and fences the new end.
+static void __heap_extend_region(__heap_block_t* fence, size_t size) {
+  __heap_block_t* new_fence = (__heap_block_t*)((uintptr_t)fence + size);
+  new_fence->head           = __HEAP_IN_USE;
+  new_fence->next           = fence->next;
+
+  fence->head = size | (fence->head & __HEAP_PREV_IN_USE) | __HEAP_IN_USE;
+  __heap_free_block(fence);
+
+  __heap_last_fence = new_fence;
+}
+
+static bool __heap_grow(size_t size) {
+  size_t region_size = size + __HEAP_ALIGN * 2;
+  void*  region      = __heap_sbrk(&region_size);
+  __if_unlikely (region == NULL) {
+    return false;
+  }
+
+  if (__heap_last_fence != NULL && (uintptr_t)__heap_last_fence + __HEAP_FENCE_SIZE == (uintptr_t)region) {
+    __heap_extend_region(__heap_last_fence, region_size);
+  } else {
+    __heap_add_region(region, region_size);
+  }
+
+  return true;
+}
+
+static bool __heap_region_idle(uintptr_t start) {
+  __heap_block_t* block = (__heap_block_t*)(start + __HEAP_ALIGN - __HEAP_WORD);
+  return (block->head & __HEAP_IN_USE) == 0 && __heap_block_size(__heap_next_block(block)) == 0;
+}
+
+// Cuts the free block at the end of the last region short at a mega page boundary and unmaps everything behind it.
+// At least a mega page of free memory is left in front of the cut.
+static void __heap_trim_last_region(__heap_block_t* block) {
+  uintptr_t end = (uintptr_t)__heap_last_fence + __HEAP_FENCE_SIZE;
+  uintptr_t cut = ((uintptr_t)block + MEGA_PAGE_SIZE * 2 - 1) / MEGA_PAGE_SIZE * MEGA_PAGE_SIZE;
+  if (cut + MEGA_PAGE_SIZE > end) {
+    return;
+  }
+
+  __heap_block_t* fence = (__heap_block_t*)(cut - __HEAP_FENCE_SIZE);
+  fence->head           = __HEAP_IN_USE;
+  fence->next           = __heap_last_fence->next;
+
+  __heap_remove_block(block);
+  __heap_set_free(block, (uintptr_t)fence - (uintptr_t)block);
+  __heap_insert_block(block);
+
+  __heap_last_fence = fence;
+  if (__brk_pos == end) {
+    __brk_pos = cut;
+  }
+
+  __heap_unmap((void*)cut, end - cut);
+}
+
+// Frees the block and hands its region back to mm if nothing in it is in use any more.
+static void __heap_release_block(__heap_block_t* block) {
+  block = __heap_free_block(block);
+
+  __heap_block_t* fence = __heap_next_block(block);
+  if (__heap_block_size(fence) != 0) {
+    return;
+  }
+
+  uintptr_t start = (uintptr_t)fence->next;
+  if ((uintptr_t)block != start + __HEAP_ALIGN - __HEAP_WORD || start == __brk_start || start == __heap_idle_region) {
+    if (fence == __heap_last_fence) {
+      __heap_trim_last_region(block);
+    }
+    return;
+  }
+
+  if (__heap_idle_region == 0 || !__heap_region_idle(__heap_idle_region)) {
+    __heap_idle_region = start;
+    return;
+  }
+
+  if (fence == __heap_last_fence) {
+    __heap_last_fence = NULL;
+  }
+
+  __heap_remove_block(block);
+  __heap_unmap((void*)start, __heap_block_size(block) + __HEAP_ALIGN * 2);
+}
+
+// Splits the tail of an in-use block off into a free block if it is large enough to stand on its own.
+static void __heap_trim_block(__heap_block_t* block, size_t size) {
+  size_t block_size = __heap_block_size(block);
+  if (block_size - size < __HEAP_MIN_BLOCK) {
+    return;
+  }
+
+  __heap_block_t* rest = (__heap_block_t*)((uintptr_t)block + size);
+  rest->head           = (block_size - size) | __HEAP_PREV_IN_USE | __HEAP_IN_USE;
+  block->head          = size | (block->head & __HEAP_FLAGS);
+  __heap_free_block(rest);
+}
+
+static __heap_block_t* __heap_alloc_block(size_t size) {
+  __heap_block_t* block = __heap_find_block(size);
+
+  if (block == NULL) {
+    __if_unlikely (!__heap_grow(size)) {
+      return NULL;
+    }
+
+    block = __heap_find_block(size);
+    __if_unlikely (block == NULL) {
+      return NULL;
+    }
+  }
+
+  __heap_remove_block(block);
+
+  block->head                    |= __HEAP_IN_USE;
+  __heap_next_block(block)->head |= __HEAP_PREV_IN_USE;
+  __heap_trim_block(block, size);
+
+  return block;
+}
+
+static __heap_block_t* __heap_alloc_block_aligned(size_t size, size_t alignment) {
+  if (alignment <= __HEAP_ALIGN) {
+    return __heap_alloc_block(size);
+  }
+
+  size_t padded_size = size + alignment + __HEAP_MIN_BLOCK;
+  __if_unlikely (padded_size < size) {
+    return NULL;
+  }
+
+  __heap_block_t* block = __heap_alloc_block(padded_size);
+  __if_unlikely (block == NULL) {
+    return NULL;
+  }
+
+  // Give the bytes in front of the aligned payload back to the heap. They must form a whole block of their own.
+  uintptr_t payload = (uintptr_t)block + __HEAP_WORD;
+  uintptr_t aligned = (payload + alignment - 1) & ~(alignment - 1);
+  if (aligned != payload) {
+    if (aligned - payload < __HEAP_MIN_BLOCK) {
+      aligned += alignment;
+    }
+
+    size_t          lead_size     = aligned - payload;
+    __heap_block_t* aligned_block = (__heap_block_t*)(aligned - __HEAP_WORD);
+    aligned_block->head           = (__heap_block_size(block) - lead_size) | __HEAP_PREV_IN_USE | __HEAP_IN_USE;
+    block->head                   = lead_size | (block->head & __HEAP_PREV_IN_USE) | __HEAP_IN_USE;
+    __heap_free_block(block);
+
+    block = aligned_block;
+  }
+
+  __heap_trim_block(block, size);
+
+  return block;
+}
+
+// Resizes an in-use block in place, taking over the following block if it is free. Fails if there is no room.
+static bool __heap_resize_block(__heap_block_t* block, size_t size) {
+  size_t block_size = __heap_block_size(block);
+
+  if (block_size < size) {
+    __heap_block_t* next = __heap_next_block(block);
+    if ((next->head & __HEAP_IN_USE) != 0 || block_size + __heap_block_size(next) < size) {
+      return false;
+    }
+
+    __heap_remove_block(next);
+    block_size                     += __heap_block_size(next);
+    block->head                     = block_size | (block->head & __HEAP_FLAGS);
+    __heap_next_block(block)->head |= __HEAP_PREV_IN_USE;
+  }
+
+  __heap_trim_block(block, size);
+
+  return true;
+}
+
+static void __heap_link_slab(__heap_slab_t* slab) {
+  slab->prev = NULL;
+  slab->next = __heap_partial_slabs[slab->cls];
+  if (slab->next != NULL) {
+    slab->next->prev = slab;
+  }
+  __heap_partial_slabs[slab->cls] = slab;
+}
+
+static void __heap_unlink_slab(__heap_slab_t* slab) {
+  if (slab->prev != NULL) {
+    slab->prev->next = slab->next;
+  } else {
+    __heap_partial_slabs[slab->cls] = slab->next;
+  }
+  if (slab->next != NULL) {
+    slab->next->prev = slab->prev;
+  }
+}
+
+static size_t __heap_slab_align(size_t cls) {
+  size_t stride = __heap_strides[cls];
+  return (stride & (stride - 1)) == 0 ? stride : __HEAP_ALIGN;
+}
+
+static uintptr_t __heap_first_slot(const __heap_slab_t* slab) {
+  size_t    align = __heap_slab_align(slab->cls);
+  uintptr_t first = ((uintptr_t)slab + __HEAP_ROUND_UP(sizeof(__heap_slab_t) + __HEAP_WORD) + align - 1) & ~(align - 1);
+  return first - __HEAP_WORD;
+}
+
+static __heap_slab_t* __heap_slab_of(void* ptr, size_t head) {
+  return (__heap_slab_t*)((uintptr_t)ptr - (head & ~__HEAP_FLAGS));
+}
+
+// A small slab and the region overhead fit in one kilo page, which is all a fresh heap has. The slab block is not
+// aligned to the stride, as the padding would not fit there. The first slot is aligned within the block instead.
+static __heap_slab_t* __heap_new_slab(size_t cls) {
+  size_t          stride    = __heap_strides[cls];
+  size_t          slab_size = stride <= __HEAP_SLAB_SPLIT ? __HEAP_SMALL_SLAB : __HEAP_LARGE_SLAB;
+  __heap_block_t* block     = __heap_alloc_block(slab_size);
+  __if_unlikely (block == NULL) {
+    return NULL;
+  }
+
+  __heap_slab_t* slab = (__heap_slab_t*)((uintptr_t)block + __HEAP_WORD);
+  slab->free_list     = NULL;
+  slab->cls           = cls;
+  slab->num_used      = 0;
+  slab->num_carved    = 0;
+  slab->num_slots     = ((uintptr_t)block + __heap_block_size(block) - __heap_first_slot(slab)) / stride;
+
+  __heap_link_slab(slab);
+
+  return slab;
+}
+
+static void* __heap_alloc_slot(size_t cls) {
+  __heap_slab_t* slab = __heap_partial_slabs[cls];
+
+  if (slab == NULL) {
+    slab = __heap_new_slab(cls);
+    __if_unlikely (slab == NULL) {
+      return NULL;
+    }
+  }
+
+  void* ptr;
+  if (slab->free_list != NULL) {
+    ptr             = slab->free_list;
+    slab->free_list = *(void**)ptr;
+  } else {
+    uintptr_t slot = __heap_first_slot(slab) + __heap_strides[cls] * slab->num_carved++;
+    ptr            = (void*)(slot + __HEAP_WORD);
+  }
+
+  *(size_t*)((uintptr_t)ptr - __HEAP_WORD) = ((uintptr_t)ptr - (uintptr_t)slab) | __HEAP_SLAB | __HEAP_IN_USE;
+
+  if (++slab->num_used == slab->num_slots) {
+    __heap_unlink_slab(slab);
+  }
+
+  return ptr;
+}
+
+static void __heap_free_small(void* ptr, size_t head) {
+  __heap_slab_t* slab = __heap_slab_of(ptr, head);
+
+  *(size_t*)((uintptr_t)ptr - __HEAP_WORD) = head & ~__HEAP_IN_USE;
+  *(void**)ptr                             = slab->free_list;
+  slab->free_list                          = ptr;
+
+  if (slab->num_used-- == slab->num_slots) {
+    __heap_link_slab(slab);
+  }
+
+  // An empty slab goes back to the block heap right away. Keeping one per class would pin the end of the heap and
+  // stop it from being trimmed. Releasing it costs no more than a merge, since the trim leaves a mega page of slack.
+  if (slab->num_used == 0) {
+    __heap_unlink_slab(slab);
+    __heap_release_block((__heap_block_t*)((uintptr_t)slab - __HEAP_WORD));
+  }
+}
+
+static void* __heap_alloc_mapped(size_t size, size_t alignment) {
+  size_t offset   = alignment > __HEAP_ALIGN ? alignment : __HEAP_ALIGN;
+  size_t map_size = (size + offset + KILO_PAGE_SIZE - 1) / KILO_PAGE_SIZE * KILO_PAGE_SIZE;
+  __if_unlikely (map_size < size) {
+    return NULL;
+  }
+
+  void* base = __heap_map(map_size);
+  __if_unlikely (base == NULL) {
+    return NULL;
+  }
+
+  // The mapping is page-aligned, so the payload lands at most `offset` bytes in.
+  uintptr_t ptr = ((uintptr_t)base + __HEAP_ALIGN + offset - 1) & ~(offset - 1);
+
+  ((uintptr_t*)ptr)[-2] = (uintptr_t)base;
+  ((size_t*)ptr)[-1]    = map_size | __HEAP_MAPPED | __HEAP_IN_USE;
+
+  return (void*)ptr;
+}
+
+static void* __heap_alloc_large(size_t size, size_t alignment) {
+  size_t block_size = __heap_block_size_for(size);
+  __if_unlikely (block_size == 0) {
+    return NULL;
+  }
+
+  if (block_size >= __HEAP_MAP_THRESHOLD || alignment >= __HEAP_MAP_THRESHOLD) {
+    return __heap_alloc_mapped(size, alignment);
+  }
+
+  __heap_block_t* block = __heap_alloc_block_aligned(block_size, alignment);
+  __if_unlikely (block == NULL) {
+    return NULL;
+  }
+
+  return (void*)((uintptr_t)block + __HEAP_WORD);
 }
 
 __weak void __heap_init() {
-  __heap_block_free_list       = (__heap_block_header_t*)__brk_start;
-  __heap_block_free_list->next = __heap_block_free_list;
-  __heap_block_free_list->size = (__brk_pos - __brk_start) - sizeof(__heap_block_header_t);
+  for (size_t cls = 0, index = 0; index < sizeof(__heap_class_of); ++index) {
+    while (__heap_strides[cls] < index * __HEAP_ALIGN) {
+      ++cls;
+    }
+    __heap_class_of[index] = cls;
+  }
+
+  __heap_add_region((void*)__brk_start, __brk_pos - __brk_start);
 }
 
 __weak void* __heap_alloc(size_t size) {
@@ -37,33 +526,78 @@ __weak void* __heap_alloc(size_t size) {
     return NULL;
   }
 
-  size = (size + alignof(max_align_t) - 1) / alignof(max_align_t) * alignof(max_align_t);
+  if (size <= __HEAP_SMALL_MAX) {
+    return __heap_alloc_slot(__heap_class_of[(size + __HEAP_WORD + __HEAP_ALIGN - 1) / __HEAP_ALIGN]);
+  }
 
-  __heap_block_header_t* header = __heap_block_free_list;
-  __heap_block_header_t* prev   = NULL;
-  do {
-    if ((header->size & 1) == 0 && header->size >= size) {
-      __heap_split(header, size);
-      header->size = size | 1;
-      return header + 1;
-    }
-    prev   = header;
-    header = header->next;
-  } while (header != __heap_block_free_list);
+  return __heap_alloc_large(size, __HEAP_ALIGN);
+}
 
-  __heap_block_header_t* new_header = __heap_sbrk();
-  __if_unlikely (new_header == NULL) {
+__weak void* __heap_alloc_aligned(size_t size, size_t alignment) {
+  __if_unlikely (size == 0 || (alignment & (alignment - 1)) != 0) {
     return NULL;
   }
 
-  new_header->next = __heap_block_free_list;
-  new_header->size = MEGA_PAGE_SIZE - sizeof(__heap_block_header_t);
-  prev->next       = new_header;
+  if (alignment <= __HEAP_ALIGN) {
+    return __heap_alloc(size);
+  }
 
-  __heap_split(new_header, size);
-  new_header->size |= 1;
+  if (size <= __HEAP_SMALL_MAX) {
+    size_t stride = alignment;
+    while (stride < size + __HEAP_WORD) {
+      stride <<= 1;
+    }
+    if (stride <= __HEAP_MAX_STRIDE) {
+      return __heap_alloc_slot(__heap_class_of[stride / __HEAP_ALIGN]);
+    }
+  }
 
-  return new_header + 1;
+  return __heap_alloc_large(size, alignment);
+}
+
+__weak void* __heap_realloc(void* ptr, size_t size, size_t alignment) {
+  if (ptr == NULL) {
+    return __heap_alloc_aligned(size, alignment);
+  }
+
+  size_t head = *(size_t*)((uintptr_t)ptr - __HEAP_WORD);
+  __if_unlikely ((head & __HEAP_IN_USE) == 0) {
+    abort();
+  }
+
+  size_t usable_size;
+  bool   aligned = alignment <= __HEAP_ALIGN || (uintptr_t)ptr % alignment == 0;
+
+  if (head & __HEAP_SLAB) {
+    usable_size = __heap_strides[__heap_slab_of(ptr, head)->cls] - __HEAP_WORD;
+    if (aligned && size <= usable_size) {
+      return ptr;
+    }
+  } else if (head & __HEAP_MAPPED) {
+    // Shrinking far below the threshold moves the data back into the heap so that the mapping can go.
+    usable_size = ((uintptr_t*)ptr)[-2] + (head & ~__HEAP_FLAGS) - (uintptr_t)ptr;
+    if (aligned && size <= usable_size && size >= __HEAP_MAP_THRESHOLD / 2) {
+      return ptr;
+    }
+  } else {
+    __heap_block_t* block      = (__heap_block_t*)((uintptr_t)ptr - __HEAP_WORD);
+    size_t          block_size = __heap_block_size_for(size);
+
+    usable_size = __heap_block_size(block) - __HEAP_WORD;
+    if (aligned && block_size != 0 && __heap_resize_block(block, block_size)) {
+      return ptr;
+    }
+  }
+
+  void* new_ptr = __heap_alloc_aligned(size, alignment);
+  __if_unlikely (new_ptr == NULL) {
+    return NULL;
+  }
+
+  memcpy(new_ptr, ptr, size < usable_size ? size : usable_size);
+  __heap_free(ptr);
+
+  return new_ptr;
 }
 
 __weak void __heap_free(void* ptr) {
@@ -71,20 +605,67 @@ __weak void __heap_free(void* ptr) {
     abort();
   }
 
-  __heap_block_header_t* header = (__heap_block_header_t*)ptr - 1;
-  if ((header->size & 1) == 0) {
+  size_t head = *(size_t*)((uintptr_t)ptr - __HEAP_WORD);
+  __if_unlikely ((head & __HEAP_IN_USE) == 0) {
     abort();
   }
 
-  header->size &= ~(size_t)1;
+  if (head & __HEAP_SLAB) {
+    __heap_free_small(ptr, head);
+  } else if (head & __HEAP_MAPPED) {
+    __heap_unmap((void*)((uintptr_t*)ptr)[-2], head & ~__HEAP_FLAGS);
+  } else {
+    __heap_release_block((__heap_block_t*)((uintptr_t)ptr - __HEAP_WORD));
+  }
 }
 
-__weak void* __heap_sbrk() {
-  uintptr_t new_pos = mm_vmap(__mm_id_cap, MEGA_PAGE, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, 0);
-  __if_unlikely (new_pos == 0) {
+__weak void* __heap_sbrk(size_t* size) {
+  // Small heaps grow by half their size in kilo pages. Past the threshold they grow in mega pages, and an extension
+  // first fills up to the next mega page boundary so that the rest can be mapped with mega pages.
+  int    level = __heap_sbrk_size + *size < __HEAP_MEGA_THRESHOLD ? KILO_PAGE : MEGA_PAGE;
+  size_t grow  = *size;
+  if (level == KILO_PAGE) {
+    if (grow < __heap_sbrk_size / 2) {
+      grow = __heap_sbrk_size / 2;
+    }
+    grow = (grow + KILO_PAGE_SIZE - 1) / KILO_PAGE_SIZE * KILO_PAGE_SIZE;
+  } else {
+    grow = (grow + MEGA_PAGE_SIZE - 1) / MEGA_PAGE_SIZE * MEGA_PAGE_SIZE;
+  }
+  __if_unlikely (grow < *size) {
     return NULL;
   }
 
-  __brk_pos = new_pos + MEGA_PAGE_SIZE;
-  return (void*)new_pos;
+  uintptr_t va_base = 0;
+  if (__brk_pos != 0) {
+    size_t extension = grow;
+    if (level == MEGA_PAGE) {
+      extension = (__brk_pos + grow + MEGA_PAGE_SIZE - 1) / MEGA_PAGE_SIZE * MEGA_PAGE_SIZE - __brk_pos;
+    }
+    va_base = mm_vmap_range(__mm_id_cap, level, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, __brk_pos, extension, 0, 0);
+    if (va_base != 0) {
+      grow = extension;
+    }
+  }
+
+  if (va_base == 0) {
+    va_base = mm_vmap_range(__mm_id_cap, level, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, MM_VA_RAMDOM, grow, 0, 0);
+    __if_unlikely (va_base == 0) {
+      return NULL;
+    }
+  }
+
+  __heap_sbrk_size += grow;
+  __brk_pos         = va_base + grow;
+  *size             = grow;
+
+  return (void*)va_base;
+}
+
+__weak void* __heap_map(size_t size) {
+  return (void*)mm_vmap_range(__mm_id_cap, MEGA_PAGE, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, MM_VA_RAMDOM, size, 0, 0);
+}
+
+__weak void __heap_unmap(void* ptr, size_t size) {
+  mm_vunmap(__mm_id_cap, (uintptr_t)ptr, size);
 }
@@ -4,6 +4,7 @@
 #include <string.h>
 
 DIR* opendir(const char* name) {
+  // Opening a missing path creates it, so the path has to be known to be a directory first.
   struct fs_file_info info;
   if (!fs_info(name, &info)) {
     return NULL;
@@ -13,18 +14,25 @@ DIR* opendir(const char* name) {
     return NULL;
   }
 
-  id_cap_t fd = fs_open(name);
+  id_cap_t fd = fs_open_info(name, &info);
   if (fd == 0) {
     return NULL;
   }
 
+  if (info.file_type != FS_FT_DIR) {
+    fs_close(fd);
+    return NULL;
+  }
+
   DIR* dp = malloc(sizeof(DIR));
   if (dp == NULL) {
     fs_close(fd);
     return NULL;
   }
 
-  dp->fd = fd;
+  dp->fd       = fd;
+  dp->buf_pos  = 0;
+  dp->buf_size = 0;
   return dp;
 }
 
@@ -35,26 +43,47 @@ int closedir(DIR* dp) {
 }
 
 struct dirent* readdir(DIR* dp) {
-  struct fs_file_info info;
-  if (!fs_read(dp->fd, &info, sizeof(info))) {
+  if (dp->buf_pos >= dp->buf_size) {
+    ssize_t n = fs_readdir(dp->fd, dp->buf, sizeof(dp->buf));
+    if (n <= 0) {
+      return NULL;
+    }
+
+    dp->buf_pos  = 0;
+    dp->buf_size = n;
+  }
+
+  struct fs_dirent dirent;
+  if (dp->buf_pos + sizeof(dirent) > dp->buf_size) {
+    dp->buf_pos = dp->buf_size;
+    return NULL;
+  }
+  memcpy(&dirent, dp->buf + dp->buf_pos, sizeof(dirent));
+
+  if (dp->buf_pos + FS_DIRENT_SIZE(dirent.file_name_size) > dp->buf_size) {
+    dp->buf_pos = dp->buf_size;
     return NULL;
   }
 
   dp->entry.d_ino = 0;
 
-  switch (info.file_type) {
+  switch (dirent.file_type) {
     case FS_FT_DIR:
       dp->entry.d_type = DT_DIR;
       break;
     case FS_FT_REG:
       dp->entry.d_type = DT_REG;
       break;
+    case FS_FT_CHR:
+      dp->entry.d_type = DT_CHR;
+      break;
     default:
       dp->entry.d_type = DT_UNKNOWN;
       break;
   }
 
-  strncpy(dp->entry.d_name, info.file_name, sizeof(dp->entry.d_name));
+  memcpy(dp->entry.d_name, dp->buf + dp->buf_pos + sizeof(dirent), dirent.file_name_size + 1);
+  dp->buf_pos += FS_DIRENT_SIZE(dirent.file_name_size);
 
   return &dp->entry;
 }
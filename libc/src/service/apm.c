@@ -1,5 +1,6 @@
 #include <apm/ipc.h>
 #include <assert.h>
+#include <crt/env.h>
 #include <crt/global.h>
 #include <internal/branch.h>
 #include <libcaprese/syscall.h>
@@ -13,6 +14,9 @@ static size_t round_up(size_t value, size_t align) {
 task_cap_t apm_create(const char* path, const char* app_name, int flags, const char** argv) {
   assert(path != NULL);
 
+  // The child inherits the environment apm holds for this task.
+  __env_sync();
+
   size_t path_len     = strlen(path) + 1;
   size_t app_name_len = app_name != NULL ? strlen(app_name) + 1 : 1;
   int    argc         = 0;
@@ -262,3 +266,68 @@ bool apm_nextenv(task_cap_t task_cap, const char* env, char* value, size_t* valu
 
   return result == APM_CODE_S_OK;
 }
+
+bool apm_dumpenv(task_cap_t task_cap, char* buf, size_t* buf_size) {
+  assert(task_cap != 0);
+  assert(buf != NULL || *buf_size == 0);
+  assert(buf_size != NULL);
+
+  size_t chunk_size = *buf_size < APM_ENV_MAX_LEN ? *buf_size : APM_ENV_MAX_LEN;
+
+  message_t* msg = new_ipc_message(sizeof(uintptr_t) * 4 + chunk_size);
+  __if_unlikely (msg == NULL) {
+    return false;
+  }
+
+  // The environment is returned as packed "NAME=VALUE\0" entries. It only takes more than one call when it does not fit in a message.
+  int    result = APM_CODE_S_OK;
+  size_t offset = 0;
+  size_t total  = 0;
+  while (true) {
+    set_ipc_data(msg, 0, APM_MSG_TYPE_DUMPENV);
+    set_ipc_cap(msg, 1, task_cap, true);
+    set_ipc_data(msg, 2, offset);
+    set_ipc_data(msg, 3, chunk_size);
+
+    sysret_t sysret = sys_endpoint_cap_call(__apm_ep_cap, msg);
+
+    __if_unlikely (sysret_failed(sysret)) {
+      delete_ipc_message(msg);
+      return false;
+    }
+
+    result = get_ipc_data(msg, 0);
+    if (result != APM_CODE_S_OK) {
+      break;
+    }
+
+    total = get_ipc_data(msg, 1);
+    if (total > *buf_size || offset > total) {
+      break;
+    }
+
+    size_t len = get_ipc_data(msg, 2);
+    if (len > total - offset) {
+      len = total - offset;
+    }
+
+    memcpy(buf + offset, get_ipc_data_ptr(msg, 3), len);
+    offset += len;
+
+    if (offset >= total || len == 0) {
+      break;
+    }
+
+    destroy_ipc_message(msg);
+  }
+
+  delete_ipc_message(msg);
+
+  if (result != APM_CODE_S_OK) {
+    return false;
+  }
+
+  *buf_size = total;
+
+  return offset == total;
+}
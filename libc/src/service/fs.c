@@ -2,8 +2,79 @@
 #include <internal/branch.h>
 #include <libcaprese/syscall.h>
 #include <service/fs.h>
+#include <service/mm.h>
+#include <stdlib.h>
 #include <string.h>
 
+// A channel lets the data operations on a redirected fd go straight to the backend that serves it.
+struct __fs_channel {
+  id_cap_t       fd;
+  endpoint_cap_t ep_cap;
+  id_cap_t       id;
+};
+
+static struct __fs_channel* __fs_channels;
+static size_t               __fs_num_channels;
+static size_t               __fs_channel_capacity;
+
+static struct __fs_channel* __fs_find_channel(id_cap_t fd) {
+  for (size_t i = 0; i < __fs_num_channels; ++i) {
+    if (__fs_channels[i].fd == fd) {
+      return &__fs_channels[i];
+    }
+  }
+  return NULL;
+}
+
+static bool __fs_add_channel(id_cap_t fd, endpoint_cap_t ep_cap, id_cap_t id) {
+  if (__fs_num_channels == __fs_channel_capacity) {
+    size_t               capacity = __fs_channel_capacity == 0 ? 8 : __fs_channel_capacity * 2;
+    struct __fs_channel* channels = realloc(__fs_channels, sizeof(struct __fs_channel) * capacity);
+    __if_unlikely (channels == NULL) {
+      return false;
+    }
+    __fs_channels         = channels;
+    __fs_channel_capacity = capacity;
+  }
+
+  __fs_channels[__fs_num_channels].fd     = fd;
+  __fs_channels[__fs_num_channels].ep_cap = ep_cap;
+  __fs_channels[__fs_num_channels].id     = id;
+  ++__fs_num_channels;
+
+  return true;
+}
+
+static void __fs_remove_channel(id_cap_t fd) {
+  struct __fs_channel* channel = __fs_find_channel(fd);
+  if (channel == NULL) {
+    return;
+  }
+
+  sys_cap_destroy(channel->ep_cap);
+  sys_cap_destroy(channel->id);
+
+  *channel = __fs_channels[--__fs_num_channels];
+}
+
+// Fills in the request header for fd and returns the index of the first argument.
+// The fs server takes [1] fd, while a backend takes [1] the channel id it issued for fd and [2] fd.
+static int __fs_prepare(message_t* msg, uintptr_t msg_type, id_cap_t fd, endpoint_cap_t* ep_cap) {
+  set_ipc_data(msg, 0, msg_type);
+
+  struct __fs_channel* channel = __fs_find_channel(fd);
+  if (channel == NULL) {
+    set_ipc_cap(msg, 1, fd, true);
+    *ep_cap = __fs_ep_cap;
+    return 2;
+  }
+
+  set_ipc_cap(msg, 1, channel->id, true);
+  set_ipc_cap(msg, 2, fd, true);
+  *ep_cap = channel->ep_cap;
+  return 3;
+}
+
 id_cap_t fs_mount(endpoint_cap_t ep_cap, const char* root_path) {
   message_t* msg = new_ipc_message(FS_MSG_CAPACITY);
   __if_unlikely (msg == NULL) {
@@ -155,6 +226,10 @@ bool fs_remove(const char* path) {
 }
 
 id_cap_t fs_open(const char* path) {
+  return fs_open_info(path, NULL);
+}
+
+id_cap_t fs_open_info(const char* path, struct fs_file_info* info) {
   message_t* msg = new_ipc_message(FS_MSG_CAPACITY);
   __if_unlikely (msg == NULL) {
     return 0;
@@ -169,12 +244,37 @@ id_cap_t fs_open(const char* path) {
     return 0;
   }
 
-  __if_unlikely (get_ipc_data(msg, 0) != FS_CODE_S_OK) {
+  int result = get_ipc_data(msg, 0);
+  __if_unlikely (result != FS_CODE_S_OK && result != FS_CODE_E_REDIRECT) {
     delete_ipc_message(msg);
     return 0;
   }
 
-  id_cap_t fd = move_ipc_cap(msg, 1);
+  id_cap_t fd         = move_ipc_cap(msg, 1);
+  int      info_index = 2;
+
+  if (result == FS_CODE_E_REDIRECT) {
+    endpoint_cap_t ep_cap = move_ipc_cap(msg, 2);
+    id_cap_t       id     = move_ipc_cap(msg, 3);
+
+    // Without a channel the fd still works through the fs server.
+    __if_unlikely (!__fs_add_channel(fd, ep_cap, id)) {
+      sys_cap_destroy(ep_cap);
+      sys_cap_destroy(id);
+    }
+
+    info_index = 4;
+  }
+
+  if (info != NULL) {
+    const void* data = get_ipc_data_ptr(msg, info_index);
+    __if_unlikely (data == NULL) {
+      delete_ipc_message(msg);
+      fs_close(fd);
+      return 0;
+    }
+    memcpy(info, data, sizeof(*info));
+  }
 
   delete_ipc_message(msg);
 
@@ -187,6 +287,8 @@ void fs_close(id_cap_t fd) {
     return;
   }
 
+  __fs_remove_channel(fd);
+
   set_ipc_data(msg, 0, FS_MSG_TYPE_CLOSE);
   set_ipc_cap(msg, 1, fd, false);
 
@@ -209,14 +311,39 @@ ssize_t fs_read(id_cap_t fd, void* buf, size_t count) {
     return -1;
   }
 
-  set_ipc_data(msg, 0, FS_MSG_TYPE_READ);
-  set_ipc_cap(msg, 1, fd, true);
-  set_ipc_data(msg, 2, count);
+  // A backend without data answers FS_CODE_E_AGAIN with an endpoint to wait on rather than blocking the fs server.
+  while (true) {
+    endpoint_cap_t ep_cap;
+    int            index = __fs_prepare(msg, FS_MSG_TYPE_READ, fd, &ep_cap);
+    set_ipc_data(msg, index, count);
 
-  sysret_t sysret = sys_endpoint_cap_call(__fs_ep_cap, msg);
-  __if_unlikely (sysret_failed(sysret)) {
-    delete_ipc_message(msg);
-    return -1;
+    sysret_t sysret = sys_endpoint_cap_call(ep_cap, msg);
+    __if_unlikely (sysret_failed(sysret)) {
+      delete_ipc_message(msg);
+      return -1;
+    }
+
+    if (get_ipc_data(msg, 0) != FS_CODE_E_AGAIN) {
+      break;
+    }
+
+    __if_unlikely (!is_ipc_cap(msg, 1)) {
+      delete_ipc_message(msg);
+      return -1;
+    }
+
+    endpoint_cap_t wait_ep_cap = move_ipc_cap(msg, 1);
+    destroy_ipc_message(msg);
+
+    sysret = sys_endpoint_cap_receive(wait_ep_cap, msg);
+    sys_cap_destroy(wait_ep_cap);
+
+    __if_unlikely (sysret_failed(sysret)) {
+      delete_ipc_message(msg);
+      return -1;
+    }
+
+    destroy_ipc_message(msg);
   }
 
   __if_unlikely (get_ipc_data(msg, 0) != FS_CODE_S_OK && get_ipc_data(msg, 0) != FS_CODE_E_EOF) {
@@ -250,12 +377,12 @@ ssize_t fs_write(id_cap_t fd, const void* buf, size_t count) {
     return -1;
   }
 
-  set_ipc_data(msg, 0, FS_MSG_TYPE_WRITE);
-  set_ipc_cap(msg, 1, fd, true);
-  set_ipc_data(msg, 2, count);
-  set_ipc_data_array(msg, 3, buf, count);
+  endpoint_cap_t ep_cap;
+  int            index = __fs_prepare(msg, FS_MSG_TYPE_WRITE, fd, &ep_cap);
+  set_ipc_data(msg, index, count);
+  set_ipc_data_array(msg, index + 1, buf, count);
 
-  sysret_t sysret = sys_endpoint_cap_call(__fs_ep_cap, msg);
+  sysret_t sysret = sys_endpoint_cap_call(ep_cap, msg);
   __if_unlikely (sysret_failed(sysret)) {
     delete_ipc_message(msg);
     return -1;
@@ -279,12 +406,12 @@ bool fs_seek(id_cap_t fd, intptr_t offset, int whence) {
     return false;
   }
 
-  set_ipc_data(msg, 0, FS_MSG_TYPE_SEEK);
-  set_ipc_cap(msg, 1, fd, true);
-  set_ipc_data(msg, 2, offset);
-  set_ipc_data(msg, 3, whence);
+  endpoint_cap_t ep_cap;
+  int            index = __fs_prepare(msg, FS_MSG_TYPE_SEEK, fd, &ep_cap);
+  set_ipc_data(msg, index, offset);
+  set_ipc_data(msg, index + 1, whence);
 
-  sysret_t sysret = sys_endpoint_cap_call(__fs_ep_cap, msg);
+  sysret_t sysret = sys_endpoint_cap_call(ep_cap, msg);
   __if_unlikely (sysret_failed(sysret)) {
     delete_ipc_message(msg);
     return false;
@@ -303,10 +430,10 @@ intptr_t fs_tell(id_cap_t fd) {
     return -1;
   }
 
-  set_ipc_data(msg, 0, FS_MSG_TYPE_TELL);
-  set_ipc_cap(msg, 1, fd, true);
+  endpoint_cap_t ep_cap;
+  __fs_prepare(msg, FS_MSG_TYPE_TELL, fd, &ep_cap);
 
-  sysret_t sysret = sys_endpoint_cap_call(__fs_ep_cap, msg);
+  sysret_t sysret = sys_endpoint_cap_call(ep_cap, msg);
   __if_unlikely (sysret_failed(sysret)) {
     delete_ipc_message(msg);
     return -1;
@@ -318,3 +445,364 @@ intptr_t fs_tell(id_cap_t fd) {
 
   return offset;
 }
+
+const void* fs_mmap(id_cap_t fd, size_t offset, size_t size, size_t* act_size) {
+  message_t* msg = new_ipc_message(FS_MSG_CAPACITY);
+  __if_unlikely (msg == NULL) {
+    return NULL;
+  }
+
+  endpoint_cap_t ep_cap;
+  int            index = __fs_prepare(msg, FS_MSG_TYPE_MMAP, fd, &ep_cap);
+  set_ipc_data(msg, index, offset);
+  set_ipc_data(msg, index + 1, size);
+
+  sysret_t sysret = sys_endpoint_cap_call(ep_cap, msg);
+  __if_unlikely (sysret_failed(sysret)) {
+    delete_ipc_message(msg);
+    return NULL;
+  }
+
+  __if_unlikely (get_ipc_data(msg, 0) != FS_CODE_S_OK) {
+    delete_ipc_message(msg);
+    return NULL;
+  }
+
+  // The backend hands the pages to mm and answers a ticket for them, so that only this task maps them into itself.
+  id_cap_t ticket    = move_ipc_cap(msg, 1);
+  size_t   file_size = get_ipc_data(msg, 2);
+
+  delete_ipc_message(msg);
+
+  __if_unlikely (unwrap_sysret(sys_cap_type(ticket)) != CAP_ID) {
+    sys_cap_destroy(ticket);
+    return NULL;
+  }
+
+  const void* addr = (const void*)mm_vtake(__mm_id_cap, ticket, MM_VMAP_FLAG_READ, MM_VA_RAMDOM, NULL);
+  sys_cap_destroy(ticket);
+
+  __if_unlikely (addr == NULL) {
+    return NULL;
+  }
+
+  if (act_size != NULL) {
+    *act_size = file_size;
+  }
+
+  return addr;
+}
+
+bool fs_munmap(const void* addr, size_t size) {
+  __if_unlikely (addr == NULL || (uintptr_t)addr % KILO_PAGE_SIZE != 0) {
+    return false;
+  }
+
+  size = (size + KILO_PAGE_SIZE - 1) / KILO_PAGE_SIZE * KILO_PAGE_SIZE;
+
+  return mm_vunmap(__mm_id_cap, (uintptr_t)addr, size);
+}
+
+bool fs_truncate(id_cap_t fd, size_t size) {
+  message_t* msg = new_ipc_message(FS_MSG_CAPACITY);
+  __if_unlikely (msg == NULL) {
+    return false;
+  }
+
+  endpoint_cap_t ep_cap;
+  int            index = __fs_prepare(msg, FS_MSG_TYPE_TRUNCATE, fd, &ep_cap);
+  set_ipc_data(msg, index, size);
+
+  sysret_t sysret = sys_endpoint_cap_call(ep_cap, msg);
+  __if_unlikely (sysret_failed(sysret)) {
+    delete_ipc_message(msg);
+    return false;
+  }
+
+  bool result = get_ipc_data(msg, 0) == FS_CODE_S_OK;
+
+  delete_ipc_message(msg);
+
+  return result;
+}
+
+ssize_t fs_readdir(id_cap_t fd, void* buf, size_t count) {
+  __if_unlikely (count > FS_READ_MAX_SIZE) {
+    return -1;
+  }
+
+  message_t* msg = new_ipc_message(FS_MSG_CAPACITY);
+  __if_unlikely (msg == NULL) {
+    return -1;
+  }
+
+  endpoint_cap_t ep_cap;
+  int            index = __fs_prepare(msg, FS_MSG_TYPE_READDIR, fd, &ep_cap);
+  set_ipc_data(msg, index, count);
+
+  sysret_t sysret = sys_endpoint_cap_call(ep_cap, msg);
+  __if_unlikely (sysret_failed(sysret)) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  if (get_ipc_data(msg, 0) == FS_CODE_E_EOF) {
+    delete_ipc_message(msg);
+    return 0;
+  }
+
+  __if_unlikely (get_ipc_data(msg, 0) != FS_CODE_S_OK) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  ssize_t     n    = get_ipc_data(msg, 1);
+  const void* data = get_ipc_data_ptr(msg, 2);
+  __if_unlikely (n <= 0 || (size_t)n > count || data == NULL) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  memcpy(buf, data, n);
+
+  delete_ipc_message(msg);
+
+  return n;
+}
+
+ssize_t fs_pread(id_cap_t fd, void* buf, size_t count, size_t offset) {
+  __if_unlikely (count > FS_READ_MAX_SIZE) {
+    return -1;
+  }
+
+  message_t* msg = new_ipc_message(FS_MSG_CAPACITY);
+  __if_unlikely (msg == NULL) {
+    return -1;
+  }
+
+  endpoint_cap_t ep_cap;
+  int            index = __fs_prepare(msg, FS_MSG_TYPE_PREAD, fd, &ep_cap);
+  set_ipc_data(msg, index, offset);
+  set_ipc_data(msg, index + 1, count);
+
+  sysret_t sysret = sys_endpoint_cap_call(ep_cap, msg);
+  __if_unlikely (sysret_failed(sysret)) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  __if_unlikely (get_ipc_data(msg, 0) != FS_CODE_S_OK && get_ipc_data(msg, 0) != FS_CODE_E_EOF) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  ssize_t n = get_ipc_data(msg, 1);
+  __if_unlikely (n < 0 || (size_t)n > count) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  if (n > 0) {
+    const void* data = get_ipc_data_ptr(msg, 2);
+    __if_unlikely (data == NULL) {
+      delete_ipc_message(msg);
+      return -1;
+    }
+
+    memcpy(buf, data, n);
+  }
+
+  delete_ipc_message(msg);
+
+  return n;
+}
+
+ssize_t fs_pwrite(id_cap_t fd, const void* buf, size_t count, size_t offset) {
+  __if_unlikely (count > FS_WRITE_MAX_SIZE) {
+    return -1;
+  }
+
+  message_t* msg = new_ipc_message(FS_MSG_CAPACITY);
+  __if_unlikely (msg == NULL) {
+    return -1;
+  }
+
+  endpoint_cap_t ep_cap;
+  int            index = __fs_prepare(msg, FS_MSG_TYPE_PWRITE, fd, &ep_cap);
+  set_ipc_data(msg, index, offset);
+  set_ipc_data(msg, index + 1, count);
+  set_ipc_data_array(msg, index + 2, buf, count);
+
+  sysret_t sysret = sys_endpoint_cap_call(ep_cap, msg);
+  __if_unlikely (sysret_failed(sysret)) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  __if_unlikely (get_ipc_data(msg, 0) != FS_CODE_S_OK && get_ipc_data(msg, 0) != FS_CODE_E_EOF) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  ssize_t n = get_ipc_data(msg, 1);
+
+  delete_ipc_message(msg);
+
+  return n;
+}
+
+// Segment i is read into buf at the sum of the sizes of the segments before it, and act_sizes[i] tells how much of it was filled.
+ssize_t fs_preadv(id_cap_t fd, const struct fs_iovec* iov, size_t iovcnt, void* buf, size_t* act_sizes) {
+  __if_unlikely (iovcnt == 0 || iovcnt > FS_IOV_MAX) {
+    return -1;
+  }
+
+  size_t total = 0;
+  for (size_t i = 0; i < iovcnt; ++i) {
+    __if_unlikely (iov[i].size > FS_READ_MAX_SIZE - total) {
+      return -1;
+    }
+    total += iov[i].size;
+  }
+
+  message_t* msg = new_ipc_message(FS_MSG_CAPACITY);
+  __if_unlikely (msg == NULL) {
+    return -1;
+  }
+
+  endpoint_cap_t ep_cap;
+  int            index = __fs_prepare(msg, FS_MSG_TYPE_PREADV, fd, &ep_cap);
+  set_ipc_data(msg, index, iovcnt);
+  set_ipc_data_array(msg, index + 1, iov, sizeof(struct fs_iovec) * iovcnt);
+
+  sysret_t sysret = sys_endpoint_cap_call(ep_cap, msg);
+  __if_unlikely (sysret_failed(sysret)) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  __if_unlikely (get_ipc_data(msg, 0) != FS_CODE_S_OK || get_ipc_data(msg, 1) != iovcnt) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  size_t act_total = 0;
+  for (size_t i = 0; i < iovcnt; ++i) {
+    act_sizes[i] = get_ipc_data(msg, 2 + i);
+    __if_unlikely (act_sizes[i] > iov[i].size) {
+      delete_ipc_message(msg);
+      return -1;
+    }
+    act_total += act_sizes[i];
+  }
+
+  const char* data = get_ipc_data_ptr(msg, 2 + iovcnt);
+  __if_unlikely (act_total > 0 && data == NULL) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  char* dst = buf;
+  for (size_t i = 0; i < iovcnt; ++i) {
+    memcpy(dst, data, act_sizes[i]);
+    data += act_sizes[i];
+    dst += iov[i].size;
+  }
+
+  delete_ipc_message(msg);
+
+  return act_total;
+}
+
+// buf holds the data of the segments back to back.
+ssize_t fs_pwritev(id_cap_t fd, const struct fs_iovec* iov, size_t iovcnt, const void* buf) {
+  __if_unlikely (iovcnt == 0 || iovcnt > FS_IOV_MAX) {
+    return -1;
+  }
+
+  size_t total = 0;
+  for (size_t i = 0; i < iovcnt; ++i) {
+    __if_unlikely (iov[i].size > FS_WRITE_MAX_SIZE - total) {
+      return -1;
+    }
+    total += iov[i].size;
+  }
+
+  message_t* msg = new_ipc_message(FS_MSG_CAPACITY);
+  __if_unlikely (msg == NULL) {
+    return -1;
+  }
+
+  endpoint_cap_t ep_cap;
+  int            index = __fs_prepare(msg, FS_MSG_TYPE_PWRITEV, fd, &ep_cap);
+  set_ipc_data(msg, index, iovcnt);
+  set_ipc_data_array(msg, index + 1, iov, sizeof(struct fs_iovec) * iovcnt);
+  set_ipc_data_array(msg, index + 1 + sizeof(struct fs_iovec) * iovcnt / sizeof(uintptr_t), buf, total);
+
+  sysret_t sysret = sys_endpoint_cap_call(ep_cap, msg);
+  __if_unlikely (sysret_failed(sysret)) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  __if_unlikely (get_ipc_data(msg, 0) != FS_CODE_S_OK && get_ipc_data(msg, 0) != FS_CODE_E_EOF) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  ssize_t n = get_ipc_data(msg, 1);
+
+  delete_ipc_message(msg);
+
+  return n;
+}
+
+ssize_t fs_readfile(const char* path, void* buf, size_t count, size_t* file_size) {
+  __if_unlikely (count > FS_READ_MAX_SIZE) {
+    return -1;
+  }
+
+  message_t* msg = new_ipc_message(FS_MSG_CAPACITY);
+  __if_unlikely (msg == NULL) {
+    return -1;
+  }
+
+  set_ipc_data(msg, 0, FS_MSG_TYPE_READFILE);
+  set_ipc_data(msg, 1, count);
+  set_ipc_data_str(msg, 2, path);
+
+  sysret_t sysret = sys_endpoint_cap_call(__fs_ep_cap, msg);
+  __if_unlikely (sysret_failed(sysret)) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  __if_unlikely (get_ipc_data(msg, 0) != FS_CODE_S_OK) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  ssize_t n = get_ipc_data(msg, 2);
+  __if_unlikely (n < 0 || (size_t)n > count) {
+    delete_ipc_message(msg);
+    return -1;
+  }
+
+  if (n > 0) {
+    const void* data = get_ipc_data_ptr(msg, 3);
+    __if_unlikely (data == NULL) {
+      delete_ipc_message(msg);
+      return -1;
+    }
+
+    memcpy(buf, data, n);
+  }
+
+  if (file_size != NULL) {
+    *file_size = get_ipc_data(msg, 1);
+  }
+
+  delete_ipc_message(msg);
+
+  return n;
+}
@@ -202,6 +202,137 @@ uintptr_t mm_vpremap(id_cap_t src_id_cap, id_cap_t dst_id_cap, int flags, virt_p
   return get_ipc_data(msg, 1);
 }
 
+uintptr_t mm_vmap_range(id_cap_t id_cap, int max_level, int flags, uintptr_t va_base, size_t size, id_cap_t src_id_cap, uintptr_t src_va_base) {
+  assert(unwrap_sysret(sys_cap_type(id_cap)) == CAP_ID);
+  assert(src_id_cap == 0 || unwrap_sysret(sys_cap_type(src_id_cap)) == CAP_ID);
+
+  char       msg_buf[sizeof(struct message_header) + sizeof(uintptr_t) * 8];
+  message_t* msg               = (message_t*)msg_buf;
+  msg->header.payload_length   = 0;
+  msg->header.payload_capacity = sizeof(msg_buf) - sizeof(struct message_header);
+
+  set_ipc_data(msg, 0, MM_MSG_TYPE_VMAP_RANGE);
+  set_ipc_cap(msg, 1, id_cap, true);
+  set_ipc_data(msg, 2, max_level);
+  set_ipc_data(msg, 3, flags);
+  set_ipc_data(msg, 4, va_base);
+  set_ipc_data(msg, 5, size);
+  if (src_id_cap != 0) {
+    set_ipc_cap(msg, 6, src_id_cap, true);
+  } else {
+    set_ipc_data(msg, 6, 0);
+  }
+  set_ipc_data(msg, 7, src_va_base);
+
+  sysret_t sysret = sys_endpoint_cap_call(__mm_ep_cap, msg);
+
+  assert(unwrap_sysret(sys_cap_type(id_cap)) == CAP_ID);
+
+  __if_unlikely (sysret_failed(sysret)) {
+    return 0;
+  }
+
+  int result = get_ipc_data(msg, 0);
+
+  __if_unlikely (result != MM_CODE_S_OK) {
+    return 0;
+  }
+
+  return get_ipc_data(msg, 1);
+}
+
+bool mm_vunmap(id_cap_t id_cap, uintptr_t va_base, size_t size) {
+  assert(unwrap_sysret(sys_cap_type(id_cap)) == CAP_ID);
+
+  char       msg_buf[sizeof(struct message_header) + sizeof(uintptr_t) * 4];
+  message_t* msg               = (message_t*)msg_buf;
+  msg->header.payload_length   = 0;
+  msg->header.payload_capacity = sizeof(msg_buf) - sizeof(struct message_header);
+
+  set_ipc_data(msg, 0, MM_MSG_TYPE_VUNMAP);
+  set_ipc_cap(msg, 1, id_cap, true);
+  set_ipc_data(msg, 2, va_base);
+  set_ipc_data(msg, 3, size);
+
+  sysret_t sysret = sys_endpoint_cap_call(__mm_ep_cap, msg);
+
+  assert(unwrap_sysret(sys_cap_type(id_cap)) == CAP_ID);
+
+  __if_unlikely (sysret_failed(sysret)) {
+    return false;
+  }
+
+  int result = get_ipc_data(msg, 0);
+
+  return result == MM_CODE_S_OK;
+}
+
+id_cap_t mm_vgive(id_cap_t id_cap, uintptr_t va_base, size_t size) {
+  assert(unwrap_sysret(sys_cap_type(id_cap)) == CAP_ID);
+
+  char       msg_buf[sizeof(struct message_header) + sizeof(uintptr_t) * 4];
+  message_t* msg               = (message_t*)msg_buf;
+  msg->header.payload_length   = 0;
+  msg->header.payload_capacity = sizeof(msg_buf) - sizeof(struct message_header);
+
+  set_ipc_data(msg, 0, MM_MSG_TYPE_VGIVE);
+  set_ipc_cap(msg, 1, id_cap, true);
+  set_ipc_data(msg, 2, va_base);
+  set_ipc_data(msg, 3, size);
+
+  sysret_t sysret = sys_endpoint_cap_call(__mm_ep_cap, msg);
+
+  assert(unwrap_sysret(sys_cap_type(id_cap)) == CAP_ID);
+
+  __if_unlikely (sysret_failed(sysret)) {
+    return 0;
+  }
+
+  int result = get_ipc_data(msg, 0);
+
+  __if_unlikely (result != MM_CODE_S_OK) {
+    return 0;
+  }
+
+  return move_ipc_cap(msg, 1);
+}
+
+uintptr_t mm_vtake(id_cap_t id_cap, id_cap_t ticket, int flags, uintptr_t va_base, size_t* act_size) {
+  assert(unwrap_sysret(sys_cap_type(id_cap)) == CAP_ID);
+  assert(unwrap_sysret(sys_cap_type(ticket)) == CAP_ID);
+
+  char       msg_buf[sizeof(struct message_header) + sizeof(uintptr_t) * 5];
+  message_t* msg               = (message_t*)msg_buf;
+  msg->header.payload_length   = 0;
+  msg->header.payload_capacity = sizeof(msg_buf) - sizeof(struct message_header);
+
+  set_ipc_data(msg, 0, MM_MSG_TYPE_VTAKE);
+  set_ipc_cap(msg, 1, id_cap, true);
+  set_ipc_cap(msg, 2, ticket, true);
+  set_ipc_data(msg, 3, flags);
+  set_ipc_data(msg, 4, va_base);
+
+  sysret_t sysret = sys_endpoint_cap_call(__mm_ep_cap, msg);
+
+  assert(unwrap_sysret(sys_cap_type(id_cap)) == CAP_ID);
+
+  __if_unlikely (sysret_failed(sysret)) {
+    return 0;
+  }
+
+  int result = get_ipc_data(msg, 0);
+
+  __if_unlikely (result != MM_CODE_S_OK) {
+    return 0;
+  }
+
+  if (act_size != NULL) {
+    *act_size = get_ipc_data(msg, 2);
+  }
+
+  return get_ipc_data(msg, 1);
+}
+
 mem_cap_t mm_fetch(size_t size, size_t alignment) {
   char       msg_buf[sizeof(struct message_header) + sizeof(uintptr_t) * 3];
   message_t* msg               = (message_t*)msg_buf;
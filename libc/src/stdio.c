@@ -1,4 +1,5 @@
 #include <crt/global.h>
+#include <crt/stdio.h>
 #include <internal/branch.h>
 #include <service/fs.h>
 #include <stdbool.h>
@@ -63,6 +64,111 @@ FILE* __stderr() {
   return &fstderr;
 }
 
+#define __IOBUF_MODES (_IONBF | _IOLBF | _IOFBF)
+
+// Bookkeeping for a stream opened by __finitialize.
+// The buffer holds either pending writes in [0, __buf_pos) or read data in [__buf_pos, read_end).
+struct __stream_state {
+  struct __stream_state* next;
+  FILE*                  stream;
+  char*                  own_buf;
+  size_t                 read_end;
+};
+
+static struct __stream_state* __streams;
+
+static struct __stream_state* __find_stream(FILE* stream) {
+  for (struct __stream_state* state = __streams; state != NULL; state = state->next) {
+    if (state->stream == stream) {
+      return state;
+    }
+  }
+  return NULL;
+}
+
+// Returns NULL when the stream is unbuffered or the buffer cannot be allocated.
+static struct __stream_state* __stream_buffer(FILE* stream) {
+  if ((stream->__mode & _IONBF) != 0 || (stream->__mode & (_IOLBF | _IOFBF)) == 0) {
+    return NULL;
+  }
+
+  struct __stream_state* state = __find_stream(stream);
+  __if_unlikely (state == NULL) {
+    return NULL;
+  }
+
+  if (stream->__buf == NULL) {
+    if (stream->__buf_size == 0) {
+      stream->__buf_size = FS_WRITE_MAX_SIZE;
+    }
+
+    state->own_buf = malloc(stream->__buf_size);
+    __if_unlikely (state->own_buf == NULL) {
+      stream->__mode = (stream->__mode & ~__IOBUF_MODES) | _IONBF;
+      return NULL;
+    }
+
+    stream->__buf     = state->own_buf;
+    stream->__buf_pos = 0;
+    state->read_end   = 0;
+  }
+
+  return state;
+}
+
+static bool __write_all(FILE* stream, const char* ptr, size_t count) {
+  while (count > 0) {
+    size_t  size = count < FS_WRITE_MAX_SIZE ? count : FS_WRITE_MAX_SIZE;
+    ssize_t n    = fs_write(stream->__fd, ptr, size);
+    __if_unlikely (n <= 0) {
+      return false;
+    }
+    ptr   += n;
+    count -= n;
+  }
+  return true;
+}
+
+static bool __flush(FILE* stream, struct __stream_state* state) {
+  if (state->read_end != 0) {
+    // The backend cursor has already moved past the unread data, so it is moved back before the data is dropped.
+    // A stream that cannot seek, such as the console, has nothing to overwrite and keeps its cursor.
+    size_t unread = state->read_end - stream->__buf_pos;
+    if (unread != 0) {
+      (void)fs_seek(stream->__fd, -(intptr_t)unread, SEEK_CUR);
+    }
+    stream->__buf_pos = 0;
+    state->read_end   = 0;
+    return true;
+  }
+
+  if (stream->__buf_pos == 0) {
+    return true;
+  }
+
+  bool result       = __write_all(stream, stream->__buf, stream->__buf_pos);
+  stream->__buf_pos = 0;
+
+  return result;
+}
+
+// Line buffered output has to reach the console before the task blocks on input.
+static void __flush_line_buffered() {
+  for (struct __stream_state* state = __streams; state != NULL; state = state->next) {
+    if ((state->stream->__mode & _IOLBF) != 0 && state->read_end == 0 && state->stream->__buf_pos != 0) {
+      __flush(state->stream, state);
+    }
+  }
+}
+
+void __stdio_flush_all() {
+  for (struct __stream_state* state = __streams; state != NULL; state = state->next) {
+    if (state->read_end == 0 && state->stream->__buf != NULL) {
+      __flush(state->stream, state);
+    }
+  }
+}
+
 static size_t __read(void* __restrict ptr, size_t size, size_t nmemb, struct __FILE* __restrict stream) {
   __if_unlikely (__fs_ep_cap == 0) {
     return 0;
@@ -72,12 +178,69 @@ static size_t __read(void* __restrict ptr, size_t size, size_t nmemb, struct __F
     return 0;
   }
 
-  ssize_t n = fs_read(stream->__fd, ptr, size * nmemb);
-  if (n < 0) {
-    return 0;
+  char*  dst   = ptr;
+  size_t count = size * nmemb;
+  size_t done  = 0;
+
+  if (count > 0 && stream->__ungetc_buf != (char)EOF) {
+    dst[done++]          = stream->__ungetc_buf;
+    stream->__ungetc_buf = EOF;
+  }
+
+  struct __stream_state* state = __stream_buffer(stream);
+
+  if (state != NULL) {
+    if (state->read_end == 0 && stream->__buf_pos != 0) {
+      __if_unlikely (!__flush(stream, state)) {
+        return done;
+      }
+    }
+
+    size_t avail = state->read_end - stream->__buf_pos;
+    size_t n     = count - done < avail ? count - done : avail;
+    memcpy(dst + done, stream->__buf + stream->__buf_pos, n);
+    done              += n;
+    stream->__buf_pos += n;
+
+    if (stream->__buf_pos == state->read_end) {
+      stream->__buf_pos = 0;
+      state->read_end   = 0;
+    }
+  }
+
+  if (done == count) {
+    return done;
+  }
+
+  if ((stream->__mode & _IOLBF) != 0) {
+    __flush_line_buffered();
+  }
+
+  if (state == NULL || count - done >= stream->__buf_size) {
+    size_t  read_size = count - done < FS_READ_MAX_SIZE ? count - done : FS_READ_MAX_SIZE;
+    ssize_t n         = fs_read(stream->__fd, dst + done, read_size);
+    if (n > 0) {
+      done += n;
+    }
+    return done;
   }
 
-  return n;
+  size_t  read_size = stream->__buf_size < FS_READ_MAX_SIZE ? stream->__buf_size : FS_READ_MAX_SIZE;
+  ssize_t n         = fs_read(stream->__fd, stream->__buf, read_size);
+  if (n <= 0) {
+    return done;
+  }
+
+  size_t copy_size = count - done < (size_t)n ? count - done : (size_t)n;
+  memcpy(dst + done, stream->__buf, copy_size);
+  done += copy_size;
+
+  if (copy_size < (size_t)n) {
+    stream->__buf_pos = copy_size;
+    state->read_end   = n;
+  }
+
+  return done;
 }
 
 static size_t __write(const void* __restrict ptr, size_t size, size_t nmemb, struct __FILE* __restrict stream) {
@@ -89,28 +252,76 @@ static size_t __write(const void* __restrict ptr, size_t size, size_t nmemb, str
     return 0;
   }
 
-  ssize_t n = fs_write(stream->__fd, ptr, size * nmemb);
-  if (n < 0) {
+  size_t                 count = size * nmemb;
+  struct __stream_state* state = __stream_buffer(stream);
+
+  if (state == NULL) {
+    return __write_all(stream, ptr, count) ? count : 0;
+  }
+
+  // An empty write is how a flush reaches the stream.
+  if (count == 0) {
+    __flush(stream, state);
     return 0;
   }
 
-  return n;
+  if (state->read_end != 0 || stream->__buf_pos + count > stream->__buf_size) {
+    __if_unlikely (!__flush(stream, state)) {
+      return 0;
+    }
+    if (count >= stream->__buf_size) {
+      return __write_all(stream, ptr, count) ? count : 0;
+    }
+  }
+
+  memcpy(stream->__buf + stream->__buf_pos, ptr, count);
+  stream->__buf_pos += count;
+
+  if (stream->__buf_pos == stream->__buf_size || ((stream->__mode & _IOLBF) != 0 && memchr(ptr, '\n', count) != NULL)) {
+    __if_unlikely (!__flush(stream, state)) {
+      return 0;
+    }
+  }
+
+  return count;
 }
 
-static int __ungetc(int ch, struct __FILE*) {
-  // TODO: impl
+static int __ungetc(int ch, struct __FILE* stream) {
+  __if_unlikely (ch == EOF) {
+    return EOF;
+  }
+
+  struct __stream_state* state = __find_stream(stream);
+
+  if (state != NULL && stream->__buf != NULL) {
+    if (state->read_end != 0 && stream->__buf_pos > 0) {
+      stream->__buf[--stream->__buf_pos] = (char)ch;
+      return ch;
+    }
+
+    if (state->read_end == 0 && stream->__buf_pos == 0) {
+      stream->__buf_pos                = stream->__buf_size - 1;
+      state->read_end                  = stream->__buf_size;
+      stream->__buf[stream->__buf_pos] = (char)ch;
+      return ch;
+    }
+  }
+
+  if (stream->__ungetc_buf != (char)EOF) {
+    return EOF;
+  }
+
+  stream->__ungetc_buf = (char)ch;
   return ch;
 }
 
 int __finitialize(const char* __restrict filename, int, FILE* __restrict stream) {
-  id_cap_t fd = 0;
+  char* abs_path = NULL;
 
-  if (filename[0] == '/') {
-    fd = fs_open(filename);
-  } else {
-    const char* cwd      = getenv("PWD");
-    size_t      cwd_len  = strlen(cwd);
-    char*       abs_path = malloc(strlen(cwd) + 1 + strlen(filename) + 1);
+  if (filename[0] != '/') {
+    const char* cwd     = getenv("PWD");
+    size_t      cwd_len = strlen(cwd);
+    abs_path            = malloc(strlen(cwd) + 1 + strlen(filename) + 1);
 
     if (abs_path == NULL) {
       return EOF;
@@ -124,17 +335,40 @@ int __finitialize(const char* __restrict filename, int, FILE* __restrict stream)
 
     strcat(abs_path, filename);
 
-    fd = fs_open(abs_path);
+    filename = abs_path;
+  }
 
-    free(abs_path);
+  struct fs_file_info info;
+  id_cap_t            fd = fs_open_info(filename, &info);
+
+  // Consoles are line buffered and everything else is fully buffered, except for stderr.
+  int buf_mode = _IOFBF;
+  if (stream == stderr) {
+    buf_mode = _IONBF;
+  } else if (fd != 0 && info.file_type == FS_FT_CHR) {
+    buf_mode = _IOLBF;
   }
 
+  free(abs_path);
+
   __if_unlikely (fd == 0) {
     return EOF;
   }
 
+  struct __stream_state* state = malloc(sizeof(struct __stream_state));
+  __if_unlikely (state == NULL) {
+    fs_close(fd);
+    return EOF;
+  }
+
+  state->next     = __streams;
+  state->stream   = stream;
+  state->own_buf  = NULL;
+  state->read_end = 0;
+  __streams       = state;
+
   stream->__fd         = (uintptr_t)fd;
-  stream->__mode       = stream->__mode | _IONBF;
+  stream->__mode       = (stream->__mode & ~__IOBUF_MODES) | buf_mode;
   stream->__ungetc_buf = EOF;
   stream->__buf        = NULL;
   stream->__buf_size   = 0;
@@ -146,6 +380,33 @@ int __finitialize(const char* __restrict filename, int, FILE* __restrict stream)
   return 0;
 }
 
-int __ffinalize(FILE*) {
-  return 0;
+int __ffinalize(FILE* stream) {
+  struct __stream_state** link = &__streams;
+  while (*link != NULL && (*link)->stream != stream) {
+    link = &(*link)->next;
+  }
+
+  struct __stream_state* state = *link;
+  if (state == NULL) {
+    return 0;
+  }
+
+  *link = state->next;
+
+  int result = 0;
+  if (stream->__buf != NULL && !__flush(stream, state)) {
+    result = EOF;
+  }
+
+  free(state->own_buf);
+  free(state);
+
+  fs_close(stream->__fd);
+
+  stream->__fd       = 0;
+  stream->__buf      = NULL;
+  stream->__buf_size = 0;
+  stream->__buf_pos  = 0;
+
+  return result;
 }
@@ -1,3 +1,4 @@
+#include <crt/env.h>
 #include <crt/global.h>
 #include <crt/heap.h>
 #include <internal/attribute.h>
@@ -18,9 +19,11 @@ void* __alloc(void* ptr, size_t size, size_t alignment) {
     return NULL;
   }
 
-  ptr = __heap_alloc(size + alignment);
+  if (ptr != NULL) {
+    return __heap_realloc(ptr, size, alignment);
+  }
 
-  return ptr;
+  return __heap_alloc_aligned(size, alignment);
 }
 
 void free(void* ptr) {
@@ -32,23 +35,12 @@ void free(void* ptr) {
 }
 
 char* getenv(const char* name) {
-  static char env_buf[APM_ENV_MAX_LEN];
-  size_t      size = sizeof(env_buf);
-
-  if (!apm_getenv(__this_task_cap, name, env_buf, &size)) {
-    return NULL;
-  }
-
-  return env_buf;
+  return __env_get(name);
 }
 
 int setenv(const char* name, const char* value, int overwrite) {
-  if (overwrite) {
-    apm_setenv(__this_task_cap, name, value);
-  } else {
-    if (getenv(name) == NULL) {
-      apm_setenv(__this_task_cap, name, value);
-    }
+  __if_unlikely (!__env_set(name, value, overwrite)) {
+    return -1;
   }
 
   return 0;
@@ -1,15 +1,23 @@
 #ifndef MM_IPC_H_
 #define MM_IPC_H_
 
-#define MM_MSG_TYPE_ATTACH  1
-#define MM_MSG_TYPE_DETACH  2
-#define MM_MSG_TYPE_VMAP    3
-#define MM_MSG_TYPE_VREMAP  4
-#define MM_MSG_TYPE_VPMAP   5
-#define MM_MSG_TYPE_VPREMAP 6
-#define MM_MSG_TYPE_FETCH   7
-#define MM_MSG_TYPE_REVOKE  8
-#define MM_MSG_TYPE_INFO    9
+// VGIVE moves a range out of a task into mm and answers a ticket id for it. VTAKE moves the range behind a ticket into
+// another task and consumes the ticket. Pages change hands this way without either task holding the other's id.
+// VMAP_RANGE with a source moves the pages mapped there. If it fails part way, the pages already moved go back to the
+// source with the flags of the request, not the ones they had before.
+#define MM_MSG_TYPE_ATTACH     1
+#define MM_MSG_TYPE_DETACH     2
+#define MM_MSG_TYPE_VMAP       3
+#define MM_MSG_TYPE_VREMAP     4
+#define MM_MSG_TYPE_VPMAP      5
+#define MM_MSG_TYPE_VPREMAP    6
+#define MM_MSG_TYPE_FETCH      7
+#define MM_MSG_TYPE_REVOKE     8
+#define MM_MSG_TYPE_INFO       9
+#define MM_MSG_TYPE_VMAP_RANGE 10
+#define MM_MSG_TYPE_VUNMAP     11
+#define MM_MSG_TYPE_VGIVE      12
+#define MM_MSG_TYPE_VTAKE      13
 
 #define MM_CODE_S_OK               0
 #define MM_CODE_E_FAILURE          1
@@ -4,6 +4,7 @@
 #include <libcaprese/cxx/id_map.h>
 #include <libcaprese/syscall.h>
 #include <map>
+#include <mm/va_allocator.h>
 
 struct task_info {
   task_cap_t                                           task_cap;
@@ -13,15 +14,26 @@ struct task_info {
   size_t                                               total_commit;
   std::map<int, std::map<uintptr_t, page_table_cap_t>> page_table_caps;
   std::map<uintptr_t, virt_page_cap_t>                 virt_page_caps;
+  std::map<uintptr_t, mem_cap_t>                       virt_page_mem_caps;
+  std::map<page_table_cap_t, mem_cap_t>                page_table_mem_caps;
+  va_allocator                                         va_ranges;
+};
+
+// A range given away with VGIVE, parked in the address space of mm until it is taken.
+struct held_range {
+  uintptr_t va_base;
+  size_t    size;
 };
 
 class task_table {
-  uintptr_t                  user_space_end;
-  int                        max_page;
-  caprese::id_map<task_info> table;
+  uintptr_t                   user_space_end;
+  int                         max_page;
+  caprese::id_map<task_info>  table;
+  caprese::id_map<held_range> held_ranges;
 
   static constexpr uintptr_t default_stack_available = MEGA_PAGE_SIZE;
   static constexpr uintptr_t default_total_available = static_cast<uintptr_t>(32) * GIGA_PAGE_SIZE;
+  static constexpr uintptr_t random_va_start         = 10 * MEGA_PAGE_SIZE;
 
 public:
   task_table();
@@ -38,14 +50,21 @@ public:
   int        vremap(id_cap_t src_id, id_cap_t dst_id, int flags, uintptr_t src_va_base, uintptr_t dst_va_base, uintptr_t* act_va_base);
   int        vpmap(id_cap_t id, int flags, virt_page_cap_t virt_page_cap, uintptr_t va_base, uintptr_t* act_va_base);
   int        vpremap(id_cap_t src_id, id_cap_t dst_id, int flags, virt_page_cap_t virt_page_cap, uintptr_t va_base, uintptr_t* act_va_base);
+  int        vmap_range(id_cap_t id, int max_level, int flags, uintptr_t va_base, size_t size, id_cap_t src_id, uintptr_t src_va_base, uintptr_t* act_va_base);
+  int        vunmap(id_cap_t id, uintptr_t va_base, size_t size);
+  int        vgive(id_cap_t id, uintptr_t va_base, size_t size, id_cap_t* ticket);
+  int        vtake(id_cap_t id, id_cap_t ticket, int flags, uintptr_t va_base, uintptr_t* act_va_base, size_t* act_size);
   int        grow_stack(id_cap_t id, size_t size, const void* data, size_t data_size);
   task_info& get_task_info(id_cap_t id);
 
 private:
   uintptr_t        random_va(id_cap_t id, int level);
   page_table_cap_t walk(id_cap_t id, int level, uintptr_t va_base);
+  void             release_page_tables(task_info& info, int level, uintptr_t va_base);
   int              map(id_cap_t id, int level, int flags, uintptr_t va_base, const void* data, size_t data_size);
   int              remap(id_cap_t src_id, id_cap_t dst_id, int level, int flags, uintptr_t src_va_base, uintptr_t dst_va_base);
+  void             unmap(id_cap_t id, uintptr_t va_base);
+  void             release(task_info& info);
 };
 
 int        attach_task(id_cap_t id, task_cap_t task, page_table_cap_t root_page_table, size_t stack_available, size_t total_available, size_t stack_commit, bool internal, const void* stack_data, size_t stack_data_size);
@@ -54,6 +73,10 @@ int        vmap_task(id_cap_t id, int level, int flags, uintptr_t va_base, uintp
 int        vremap_task(id_cap_t src_id, id_cap_t dst_id, int flags, uintptr_t src_va_base, uintptr_t dst_va_base, uintptr_t* act_va_base);
 int        vpmap_task(id_cap_t id, int flags, virt_page_cap_t virt_page_cap, uintptr_t va_base, uintptr_t* act_va_base);
 int        vpremap_task(id_cap_t src_id, id_cap_t dst_id, int flags, virt_page_cap_t virt_page_cap, uintptr_t va_base, uintptr_t* act_va_base);
+int        vmap_range_task(id_cap_t id, int max_level, int flags, uintptr_t va_base, size_t size, id_cap_t src_id, uintptr_t src_va_base, uintptr_t* act_va_base);
+int        vunmap_task(id_cap_t id, uintptr_t va_base, size_t size);
+int        vgive_task(id_cap_t id, uintptr_t va_base, size_t size, id_cap_t* ticket);
+int        vtake_task(id_cap_t id, id_cap_t ticket, int flags, uintptr_t va_base, uintptr_t* act_va_base, size_t* act_size);
 int        grow_stack(id_cap_t id, size_t size);
 task_info& get_task_info(id_cap_t id);
 
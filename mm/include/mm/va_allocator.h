@@ -0,0 +1,30 @@
+#ifndef MM_VA_ALLOCATOR_H_
+#define MM_VA_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+
+class va_allocator {
+  uintptr_t                              domain_start;
+  uintptr_t                              domain_end;
+  std::map<uintptr_t, size_t>            free_ranges;
+  std::set<std::pair<size_t, uintptr_t>> free_sizes;
+
+public:
+  va_allocator();
+  va_allocator(uintptr_t start, uintptr_t end);
+
+  uintptr_t find(size_t size, size_t alignment, uintptr_t min_base) const;
+  bool      is_free(uintptr_t base, size_t size) const;
+  bool      reserve(uintptr_t base, size_t size);
+  void      release(uintptr_t base, size_t size);
+
+private:
+  void insert(uintptr_t base, size_t size);
+  void erase(std::map<uintptr_t, size_t>::iterator it);
+};
+
+#endif // MM_VA_ALLOCATOR_H_
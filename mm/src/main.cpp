@@ -11,12 +11,30 @@
 id_cap_t __this_id_cap;
 
 extern "C" {
-  void* __heap_sbrk() {
-    if (vmap_task(__this_id_cap, MEGA_PAGE, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, 0, &__brk_pos) != MM_CODE_S_OK) {
+  void* __heap_sbrk(size_t* size) {
+    uintptr_t va_base;
+    size_t    map_size = (*size + MEGA_PAGE_SIZE - 1) / MEGA_PAGE_SIZE * MEGA_PAGE_SIZE;
+    if (vmap_range_task(__this_id_cap, MEGA_PAGE, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, MM_VA_RAMDOM, map_size, 0, 0, &va_base) != MM_CODE_S_OK) {
       return nullptr;
     }
 
-    return reinterpret_cast<void*>(__brk_pos);
+    __brk_pos = va_base + map_size;
+    *size     = map_size;
+
+    return reinterpret_cast<void*>(va_base);
+  }
+
+  void* __heap_map(size_t size) {
+    uintptr_t va_base;
+    if (vmap_range_task(__this_id_cap, MEGA_PAGE, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, MM_VA_RAMDOM, size, 0, 0, &va_base) != MM_CODE_S_OK) {
+      return nullptr;
+    }
+
+    return reinterpret_cast<void*>(va_base);
+  }
+
+  void __heap_unmap(void* ptr, size_t size) {
+    vunmap_task(__this_id_cap, reinterpret_cast<uintptr_t>(ptr), size);
   }
 }
 
@@ -130,6 +148,10 @@ namespace {
       info.page_table_caps[level][unwrap_sysret(sys_page_table_cap_virt_addr_base(cap))] = cap;
     }
 
+    // The pages of the init task image are not known here, so the whole range its kilo page table covers stays reserved.
+    uintptr_t image_base = unwrap_sysret(sys_page_table_cap_virt_addr_base(page_table_caps[KILO_PAGE]));
+    info.va_ranges.reserve(image_base, MEGA_PAGE_SIZE);
+
     return init_id_cap;
   }
 
@@ -146,6 +168,8 @@ namespace {
 
     task_info& info = get_task_info(__this_id_cap);
 
+    info.va_ranges.reserve(__brk_start, __brk_pos - __brk_start);
+
     for (size_t i = 0, len = get_message_size(msg); i < len; ++i) {
       if (!is_ipc_cap(msg, i)) {
         continue;
@@ -155,7 +179,9 @@ namespace {
       cap_type_t type = static_cast<cap_type_t>(unwrap_sysret(sys_cap_type(cap)));
       if (type == CAP_VIRT_PAGE) {
         uintptr_t va            = unwrap_sysret(sys_virt_page_cap_virt_addr(cap));
+        int       level         = unwrap_sysret(sys_virt_page_cap_level(cap));
         info.virt_page_caps[va] = move_ipc_cap(msg, i);
+        info.va_ranges.reserve(va, get_page_size(level));
       } else if (type == CAP_PAGE_TABLE) {
         int       level                 = unwrap_sysret(sys_page_table_cap_level(cap));
         uintptr_t va                    = unwrap_sysret(sys_page_table_cap_virt_addr_base(cap));
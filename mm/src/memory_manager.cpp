@@ -1,7 +1,10 @@
+#include <algorithm>
 #include <libcaprese/syscall.h>
 #include <map>
 #include <mm/ipc.h>
 #include <mm/memory_manager.h>
+#include <optional>
+#include <vector>
 
 namespace {
   struct mem_info_t {
@@ -10,8 +13,172 @@ namespace {
     size_t    size;
   };
 
+  struct region_t {
+    mem_cap_t cap;
+    uintptr_t phys_addr;
+    size_t    size;
+    size_t    used_size;
+  };
+
+  // A size class hands out memory objects of exactly `size` bytes aligned to `alignment`.
+  // Objects are carved out of a slab taken from the parent class, or directly from the RAM regions for the top classes.
+  struct size_class_t {
+    size_t                 size;
+    size_t                 alignment;
+    int                    parent;
+    std::vector<mem_cap_t> free_list;
+    mem_cap_t              slab_cap;
+    size_t                 slab_rem_size;
+  };
+
   std::map<uintptr_t, mem_info_t> dev_mem_caps;
-  std::map<uintptr_t, mem_info_t> ram_mem_caps;
+  std::map<uintptr_t, region_t>   ram_mem_caps;
+
+  std::map<uintptr_t, region_t>::iterator current_region = ram_mem_caps.end();
+
+  std::vector<size_class_t> size_classes;
+
+  // Returned memory objects that do not belong to any size class, keyed by their size.
+  std::multimap<size_t, mem_cap_t> spare_mem_caps;
+
+  constexpr int no_parent = -1;
+
+  std::optional<int> find_size_class(size_t size, size_t alignment) {
+    for (size_t i = 0; i < size_classes.size(); ++i) {
+      const size_class_t& size_class = size_classes[i];
+      if (size_class.size >= size && size_class.size < size * 2 && size_class.alignment % alignment == 0) {
+        return static_cast<int>(i);
+      }
+    }
+    return std::nullopt;
+  }
+
+  void add_size_class(size_t size, size_t alignment) {
+    if (size == 0) [[unlikely]] {
+      return;
+    }
+
+    if (alignment == 0) {
+      alignment = 1;
+    }
+
+    for (const size_class_t& size_class : size_classes) {
+      if (size_class.size == size && size_class.alignment == alignment) {
+        return;
+      }
+    }
+
+    size_classes.push_back({ size, alignment, no_parent, {}, 0, 0 });
+  }
+
+  void init_size_classes() {
+    add_size_class(KILO_PAGE_SIZE, KILO_PAGE_SIZE);
+    add_size_class(MEGA_PAGE_SIZE, MEGA_PAGE_SIZE);
+    if (get_max_page() >= GIGA_PAGE) {
+      add_size_class(GIGA_PAGE_SIZE, GIGA_PAGE_SIZE);
+    }
+
+    for (cap_type_t type : { CAP_CAP_SPACE, CAP_PAGE_TABLE, CAP_TASK, CAP_ENDPOINT }) {
+      add_size_class(unwrap_sysret(sys_system_cap_size(type)), unwrap_sysret(sys_system_cap_align(type)));
+    }
+
+    std::sort(size_classes.begin(), size_classes.end(), [](const size_class_t& lhs, const size_class_t& rhs) {
+      return lhs.size < rhs.size || (lhs.size == rhs.size && lhs.alignment < rhs.alignment);
+    });
+
+    // Each class takes its slabs from the smallest page-sized class that is strictly larger than itself.
+    for (size_t i = 0; i < size_classes.size(); ++i) {
+      for (size_t j = i + 1; j < size_classes.size(); ++j) {
+        if (size_classes[j].size > size_classes[i].size && size_classes[j].size % KILO_PAGE_SIZE == 0 && size_classes[j].alignment == size_classes[j].size) {
+          size_classes[i].parent = static_cast<int>(j);
+          break;
+        }
+      }
+    }
+
+    // Anything above a mega page is rare; allocate it straight from the regions so that a giga page is not pinned by it.
+    for (size_class_t& size_class : size_classes) {
+      if (size_class.size >= MEGA_PAGE_SIZE) {
+        size_class.parent = no_parent;
+      }
+    }
+  }
+
+  mem_cap_t carve_from_regions(size_t size, size_t alignment) {
+    if (ram_mem_caps.empty()) [[unlikely]] {
+      return 0;
+    }
+
+    if (current_region == ram_mem_caps.end()) {
+      current_region = ram_mem_caps.begin();
+    }
+
+    auto it = current_region;
+    do {
+      region_t& region = it->second;
+
+      uintptr_t base_addr = (region.phys_addr + region.used_size + alignment - 1) / alignment * alignment;
+      if (base_addr + size <= region.phys_addr + region.size) {
+        sysret_t sysret = sys_mem_cap_create_memory_object(region.cap, size, alignment);
+        if (sysret_succeeded(sysret)) {
+          region.used_size = base_addr + size - region.phys_addr;
+          current_region   = it;
+          return sysret.result;
+        }
+        region.used_size = unwrap_sysret(sys_mem_cap_used_size(region.cap));
+      }
+
+      if (++it == ram_mem_caps.end()) {
+        it = ram_mem_caps.begin();
+      }
+    } while (it != current_region);
+
+    return 0;
+  }
+
+  mem_cap_t fetch_from_size_class(int index) {
+    size_class_t& size_class = size_classes[index];
+
+    if (!size_class.free_list.empty()) {
+      mem_cap_t mem_cap = size_class.free_list.back();
+      size_class.free_list.pop_back();
+      return mem_cap;
+    }
+
+    if (size_class.parent == no_parent) {
+      return carve_from_regions(size_class.size, size_class.alignment);
+    }
+
+    if (size_class.slab_cap != 0) {
+      sysret_t sysret = sys_mem_cap_create_memory_object(size_class.slab_cap, size_class.size, size_class.alignment);
+      if (sysret_succeeded(sysret)) {
+        size_class.slab_rem_size -= size_class.size;
+        if (size_class.slab_rem_size < size_class.size) {
+          size_class.slab_cap = 0;
+        }
+        return sysret.result;
+      }
+    }
+
+    mem_cap_t slab_cap = fetch_from_size_class(size_class.parent);
+    if (slab_cap == 0) [[unlikely]] {
+      return carve_from_regions(size_class.size, size_class.alignment);
+    }
+
+    sysret_t sysret = sys_mem_cap_create_memory_object(slab_cap, size_class.size, size_class.alignment);
+    if (sysret_failed(sysret)) [[unlikely]] {
+      size_classes[size_class.parent].free_list.push_back(slab_cap);
+      return 0;
+    }
+
+    size_class.slab_cap      = slab_cap;
+    size_class.slab_rem_size = size_classes[size_class.parent].size - size_class.size;
+    if (size_class.slab_rem_size < size_class.size) {
+      size_class.slab_cap = 0;
+    }
+
+    return sysret.result;
+  }
 } // namespace
 
 void register_mem_cap(mem_cap_t mem_cap) {
@@ -26,52 +193,67 @@ void register_mem_cap(mem_cap_t mem_cap) {
     dev_mem_caps[phys_addr] = { mem_cap, phys_addr, size };
   } else {
     assert(!ram_mem_caps.contains(phys_addr));
-    ram_mem_caps[phys_addr] = { mem_cap, phys_addr, size };
+    size_t used_size        = unwrap_sysret(sys_mem_cap_used_size(mem_cap));
+    ram_mem_caps[phys_addr] = { mem_cap, phys_addr, size, used_size };
+    current_region          = ram_mem_caps.end();
   }
 }
 
 mem_cap_t fetch_mem_cap(size_t size, size_t alignment) {
-  cap_t  mem_cap      = 0;
-  size_t mem_cap_size = 0;
+  if (size == 0) [[unlikely]] {
+    return 0;
+  }
 
   if (alignment == 0) {
     alignment = 1;
   }
 
-  for (const auto& [phys_addr, mem_info] : ram_mem_caps) {
-    assert(mem_info.phys_addr == unwrap_sysret(sys_mem_cap_phys_addr(mem_info.cap)));
-    assert(mem_info.size == unwrap_sysret(sys_mem_cap_size(mem_info.cap)));
+  if (size_classes.empty()) [[unlikely]] {
+    init_size_classes();
+  }
+
+  if (auto index = find_size_class(size, alignment)) {
+    return fetch_from_size_class(*index);
+  }
 
-    if (mem_info.size < size) {
-      continue;
+  for (auto it = spare_mem_caps.lower_bound(size); it != spare_mem_caps.end() && it->first < size * 2; ++it) {
+    if (unwrap_sysret(sys_mem_cap_phys_addr(it->second)) % alignment == 0) {
+      mem_cap_t mem_cap = it->second;
+      spare_mem_caps.erase(it);
+      return mem_cap;
     }
+  }
 
-    uintptr_t end_addr  = phys_addr + mem_info.size;
-    uintptr_t used_size = unwrap_sysret(sys_mem_cap_used_size(mem_info.cap));
-    uintptr_t base_addr = (phys_addr + used_size + alignment - 1) / alignment * alignment;
+  return carve_from_regions(size, alignment);
+}
 
-    if (base_addr >= end_addr) {
-      continue;
-    }
+void revoke_mem_cap(mem_cap_t mem_cap) {
+  assert(unwrap_sysret(sys_cap_type(mem_cap)) == CAP_MEM);
 
-    uintptr_t rem_size = mem_info.size - (base_addr - phys_addr);
+  if (unwrap_sysret(sys_mem_cap_device(mem_cap))) [[unlikely]] {
+    sys_cap_destroy(mem_cap);
+    return;
+  }
 
-    if (rem_size >= size) {
-      if (mem_cap_size == 0 || mem_cap_size > mem_info.size) {
-        mem_cap      = mem_info.cap;
-        mem_cap_size = mem_info.size;
-      }
-    }
+  // Destroy every object created out of the memory object so that it can be handed out again as a fresh one.
+  if (sysret_failed(sys_cap_revoke(mem_cap))) [[unlikely]] {
+    sys_cap_destroy(mem_cap);
+    return;
   }
 
-  sysret_t sysret = sys_mem_cap_create_memory_object(mem_cap, size, alignment);
-  if (sysret_failed(sysret)) [[unlikely]] {
-    return 0;
+  uintptr_t phys_addr = unwrap_sysret(sys_mem_cap_phys_addr(mem_cap));
+  size_t    size      = unwrap_sysret(sys_mem_cap_size(mem_cap));
+
+  if (size_classes.empty()) [[unlikely]] {
+    init_size_classes();
   }
 
-  return sysret.result;
-}
+  for (size_class_t& size_class : size_classes) {
+    if (size_class.size == size && phys_addr % size_class.alignment == 0) {
+      size_class.free_list.push_back(mem_cap);
+      return;
+    }
+  }
 
-void revoke_mem_cap(mem_cap_t mem_cap) {
-  (void)mem_cap;
+  spare_mem_caps.emplace(size, mem_cap);
 }
@@ -205,6 +205,110 @@ namespace {
     set_ipc_data(msg, 0, MM_CODE_S_OK);
   }
 
+  void vmap_range(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == MM_MSG_TYPE_VMAP_RANGE);
+
+    id_cap_t  id_cap      = get_ipc_cap(msg, 1);
+    int       max_level   = get_ipc_data(msg, 2);
+    int       flags       = get_ipc_data(msg, 3);
+    uintptr_t va_base     = get_ipc_data(msg, 4);
+    size_t    size        = get_ipc_data(msg, 5);
+    id_cap_t  src_id_cap  = is_ipc_cap(msg, 6) ? get_ipc_cap(msg, 6) : 0;
+    uintptr_t src_va_base = get_ipc_data(msg, 7);
+
+    if (unwrap_sysret(sys_cap_type(id_cap)) != CAP_ID || (src_id_cap != 0 && unwrap_sysret(sys_cap_type(src_id_cap)) != CAP_ID)) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, MM_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    uintptr_t act_va_base;
+    int       result = vmap_range_task(id_cap, max_level, flags, va_base, size, src_id_cap, src_va_base, &act_va_base);
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+
+    if (result != MM_CODE_S_OK) [[unlikely]] {
+      return;
+    }
+
+    set_ipc_data(msg, 1, act_va_base);
+  }
+
+  void vunmap(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == MM_MSG_TYPE_VUNMAP);
+
+    id_cap_t  id_cap  = get_ipc_cap(msg, 1);
+    uintptr_t va_base = get_ipc_data(msg, 2);
+    size_t    size    = get_ipc_data(msg, 3);
+
+    if (unwrap_sysret(sys_cap_type(id_cap)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, MM_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    int result = vunmap_task(id_cap, va_base, size);
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+  }
+
+  void vgive(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == MM_MSG_TYPE_VGIVE);
+
+    id_cap_t  id_cap  = get_ipc_cap(msg, 1);
+    uintptr_t va_base = get_ipc_data(msg, 2);
+    size_t    size    = get_ipc_data(msg, 3);
+
+    if (unwrap_sysret(sys_cap_type(id_cap)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, MM_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    id_cap_t ticket;
+    int      result = vgive_task(id_cap, va_base, size, &ticket);
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+
+    if (result != MM_CODE_S_OK) [[unlikely]] {
+      return;
+    }
+
+    set_ipc_cap(msg, 1, unwrap_sysret(sys_id_cap_copy(ticket)), false);
+  }
+
+  void vtake(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == MM_MSG_TYPE_VTAKE);
+
+    id_cap_t  id_cap  = get_ipc_cap(msg, 1);
+    id_cap_t  ticket  = get_ipc_cap(msg, 2);
+    int       flags   = get_ipc_data(msg, 3);
+    uintptr_t va_base = get_ipc_data(msg, 4);
+
+    if (unwrap_sysret(sys_cap_type(id_cap)) != CAP_ID || unwrap_sysret(sys_cap_type(ticket)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, MM_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    uintptr_t act_va_base;
+    size_t    act_size;
+    int       result = vtake_task(id_cap, ticket, flags, va_base, &act_va_base, &act_size);
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+
+    if (result != MM_CODE_S_OK) [[unlikely]] {
+      return;
+    }
+
+    set_ipc_data(msg, 1, act_va_base);
+    set_ipc_data(msg, 2, act_size);
+  }
+
   void info(message_t* msg) {
     assert(get_ipc_data(msg, 0) == MM_MSG_TYPE_INFO);
 
@@ -215,16 +319,20 @@ namespace {
   // clang-format off
 
   constexpr void (*const table[])(message_t*) = {
-    [0]                   = nullptr,
-    [MM_MSG_TYPE_ATTACH]  = attach,
-    [MM_MSG_TYPE_DETACH]  = detach,
-    [MM_MSG_TYPE_VMAP]    = vmap,
-    [MM_MSG_TYPE_VREMAP]  = vremap,
-    [MM_MSG_TYPE_VPMAP]   = vpmap,
-    [MM_MSG_TYPE_VPREMAP] = vpremap,
-    [MM_MSG_TYPE_FETCH]   = fetch,
-    [MM_MSG_TYPE_REVOKE]  = revoke,
-    [MM_MSG_TYPE_INFO]    = info,
+    [0]                      = nullptr,
+    [MM_MSG_TYPE_ATTACH]     = attach,
+    [MM_MSG_TYPE_DETACH]     = detach,
+    [MM_MSG_TYPE_VMAP]       = vmap,
+    [MM_MSG_TYPE_VREMAP]     = vremap,
+    [MM_MSG_TYPE_VPMAP]      = vpmap,
+    [MM_MSG_TYPE_VPREMAP]    = vpremap,
+    [MM_MSG_TYPE_FETCH]      = fetch,
+    [MM_MSG_TYPE_REVOKE]     = revoke,
+    [MM_MSG_TYPE_INFO]       = info,
+    [MM_MSG_TYPE_VMAP_RANGE] = vmap_range,
+    [MM_MSG_TYPE_VUNMAP]     = vunmap,
+    [MM_MSG_TYPE_VGIVE]      = vgive,
+    [MM_MSG_TYPE_VTAKE]      = vtake,
   };
 
   // clang-format on
@@ -234,7 +342,7 @@ namespace {
 
     uintptr_t msg_type = get_ipc_data(msg, 0);
 
-    if (msg_type < MM_MSG_TYPE_ATTACH || msg_type > MM_MSG_TYPE_INFO) [[unlikely]] {
+    if (msg_type < MM_MSG_TYPE_ATTACH || msg_type > MM_MSG_TYPE_VTAKE) [[unlikely]] {
       destroy_ipc_message(msg);
       set_ipc_data(msg, 0, MM_CODE_E_ILL_ARGS);
       return;
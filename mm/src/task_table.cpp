@@ -5,6 +5,7 @@
 #include <mm/ipc.h>
 #include <mm/memory_manager.h>
 #include <mm/task_table.h>
+#include <vector>
 
 extern id_cap_t __this_id_cap;
 
@@ -26,7 +27,9 @@ task_table::task_table(): user_space_end(0), max_page(0) {
 }
 
 task_table::~task_table() {
-  // TODO: Release resources.
+  for (auto& [id, info] : table) {
+    release(info);
+  }
 }
 
 int task_table::attach(
@@ -56,13 +59,16 @@ int task_table::attach(
   }
 
   task_info& info = table[id] = {
-    .task_cap        = task,
-    .stack_available = stack_available,
-    .total_available = total_available,
-    .stack_commit    = 0,
-    .total_commit    = 0,
-    .page_table_caps = {},
-    .virt_page_caps  = {},
+    .task_cap            = task,
+    .stack_available     = stack_available,
+    .total_available     = total_available,
+    .stack_commit        = 0,
+    .total_commit        = 0,
+    .page_table_caps     = {},
+    .virt_page_caps      = {},
+    .virt_page_mem_caps  = {},
+    .page_table_mem_caps = {},
+    .va_ranges           = va_allocator(0, user_space_end - stack_available - KILO_PAGE_SIZE),
   };
 
   info.page_table_caps[max_page][0] = root_page_table;
@@ -84,13 +90,16 @@ int task_table::attach(
 }
 
 int task_table::detach(id_cap_t id) {
-  // TODO: Release resources.
-
-  if (!table.contains(id)) [[unlikely]] {
+  auto it = table.find(id);
+  if (it == table.end()) [[unlikely]] {
     return MM_CODE_E_NOT_ATTACHED;
   }
 
-  table.erase(id);
+  release(it->second);
+
+  id_cap_t id_cap = it->first;
+  table.erase(it);
+  sys_cap_destroy(id_cap);
 
   return MM_CODE_S_OK;
 }
@@ -198,7 +207,7 @@ int task_table::vpmap(id_cap_t id, int flags, virt_page_cap_t virt_page_cap, uin
     return MM_CODE_E_ILL_ARGS;
   }
 
-  if (info.virt_page_caps.contains(va_base)) [[unlikely]] {
+  if (info.virt_page_caps.contains(va_base) || !info.va_ranges.is_free(va_base, get_page_size(level))) [[unlikely]] {
     return MM_CODE_E_ALREADY_MAPPED;
   }
 
@@ -222,6 +231,7 @@ int task_table::vpmap(id_cap_t id, int flags, virt_page_cap_t virt_page_cap, uin
   }
 
   info.virt_page_caps[va_base] = virt_page_cap;
+  info.va_ranges.reserve(va_base, get_page_size(level));
 
   info.total_available += get_page_size(level);
   info.total_commit += get_page_size(level);
@@ -272,7 +282,7 @@ int task_table::vpremap(id_cap_t src_id, id_cap_t dst_id, int flags, virt_page_c
     return MM_CODE_E_ILL_ARGS;
   }
 
-  if (dst_info.virt_page_caps.contains(va_base)) [[unlikely]] {
+  if (dst_info.virt_page_caps.contains(va_base) || !dst_info.va_ranges.is_free(va_base, get_page_size(level))) [[unlikely]] {
     return MM_CODE_E_ALREADY_MAPPED;
   }
 
@@ -301,7 +311,14 @@ int task_table::vpremap(id_cap_t src_id, id_cap_t dst_id, int flags, virt_page_c
   }
 
   dst_info.virt_page_caps[va_base] = virt_page_cap;
+  dst_info.va_ranges.reserve(va_base, get_page_size(level));
   src_info.virt_page_caps.erase(src_va_base);
+  src_info.va_ranges.release(src_va_base, get_page_size(level));
+
+  if (auto it = src_info.virt_page_mem_caps.find(src_va_base); it != src_info.virt_page_mem_caps.end()) {
+    dst_info.virt_page_mem_caps[va_base] = it->second;
+    src_info.virt_page_mem_caps.erase(it);
+  }
 
   dst_info.total_available += get_page_size(level);
   dst_info.total_commit += get_page_size(level);
@@ -312,6 +329,186 @@ int task_table::vpremap(id_cap_t src_id, id_cap_t dst_id, int flags, virt_page_c
   return MM_CODE_S_OK;
 }
 
+int task_table::vmap_range(id_cap_t id, int max_level, int flags, uintptr_t va_base, size_t size, id_cap_t src_id, uintptr_t src_va_base, uintptr_t* act_va_base) {
+  if (!table.contains(id)) [[unlikely]] {
+    return MM_CODE_E_NOT_ATTACHED;
+  }
+
+  if (src_id != 0 && !table.contains(src_id)) [[unlikely]] {
+    return MM_CODE_E_NOT_ATTACHED;
+  }
+
+  if (max_level < KILO_PAGE || max_level > max_page) [[unlikely]] {
+    return MM_CODE_E_ILL_ARGS;
+  }
+
+  if (size == 0 || size % KILO_PAGE_SIZE != 0 || src_va_base % KILO_PAGE_SIZE != 0) [[unlikely]] {
+    return MM_CODE_E_ILL_ARGS;
+  }
+
+  task_info& info = table.at(id);
+
+  if (va_base == MM_VA_RAMDOM) {
+    int level = max_level;
+    while (level > KILO_PAGE && size < get_page_size(level)) {
+      --level;
+    }
+    va_base = info.va_ranges.find(size, get_page_size(level), random_va_start);
+    if (va_base == 0) [[unlikely]] {
+      return MM_CODE_E_OVERFLOW;
+    }
+  }
+
+  if (va_base % KILO_PAGE_SIZE != 0) [[unlikely]] {
+    return MM_CODE_E_ILL_ARGS;
+  }
+
+  if (user_space_end - info.stack_available - KILO_PAGE_SIZE < va_base + size || va_base + size < va_base) [[unlikely]] {
+    return MM_CODE_E_ILL_ARGS;
+  }
+
+  if (!info.va_ranges.is_free(va_base, size)) [[unlikely]] {
+    return MM_CODE_E_ALREADY_MAPPED;
+  }
+
+  if (src_id != 0) {
+    // The initial data is the pages already mapped at the source range; they are moved as they are, so their levels decide the leaves.
+    task_info&       src_info = table.at(src_id);
+    std::vector<int> levels;
+
+    for (size_t offset = 0; offset < size;) {
+      auto it = src_info.virt_page_caps.find(src_va_base + offset);
+      if (it == src_info.virt_page_caps.end()) [[unlikely]] {
+        return MM_CODE_E_NOT_MAPPED;
+      }
+
+      int    level     = static_cast<int>(unwrap_sysret(sys_virt_page_cap_level(it->second)));
+      size_t page_size = get_page_size(level);
+      if ((va_base + offset) % page_size != 0 || offset + page_size > size) [[unlikely]] {
+        return MM_CODE_E_ILL_ARGS;
+      }
+
+      levels.push_back(level);
+      offset += page_size;
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < levels.size(); ++i) {
+      int result = remap(src_id, id, levels[i], flags, src_va_base + offset, va_base + offset);
+      if (result != MM_CODE_S_OK) [[unlikely]] {
+        // Hand the pages moved so far back to the source. The kernel cannot report a page's flags, so they come back with the flags of this request.
+        while (i-- > 0) {
+          offset -= get_page_size(levels[i]);
+          (void)remap(id, src_id, levels[i], flags, va_base + offset, src_va_base + offset);
+        }
+        return result;
+      }
+      offset += get_page_size(levels[i]);
+    }
+  } else {
+    for (size_t offset = 0; offset < size;) {
+      int level = max_level;
+      while (level > KILO_PAGE && ((va_base + offset) % get_page_size(level) != 0 || offset + get_page_size(level) > size)) {
+        --level;
+      }
+
+      int result = map(id, level, flags, va_base + offset, nullptr, 0);
+      if (result != MM_CODE_S_OK) [[unlikely]] {
+        // Each page mapped so far holds its own reservation and frame, which unmap gives back.
+        for (auto it = info.virt_page_caps.lower_bound(va_base); it != info.virt_page_caps.end() && it->first < va_base + offset;) {
+          uintptr_t page_va_base = it->first;
+          ++it;
+          unmap(id, page_va_base);
+        }
+        return result;
+      }
+      offset += get_page_size(level);
+    }
+  }
+
+  *act_va_base = va_base;
+
+  return MM_CODE_S_OK;
+}
+
+int task_table::vunmap(id_cap_t id, uintptr_t va_base, size_t size) {
+  if (!table.contains(id)) [[unlikely]] {
+    return MM_CODE_E_NOT_ATTACHED;
+  }
+
+  if (size == 0 || size % KILO_PAGE_SIZE != 0 || va_base % KILO_PAGE_SIZE != 0 || va_base + size < va_base) [[unlikely]] {
+    return MM_CODE_E_ILL_ARGS;
+  }
+
+  task_info&             info = table.at(id);
+  std::vector<uintptr_t> pages;
+
+  // Check the whole range first so that a bad request leaves the address space untouched.
+  for (size_t offset = 0; offset < size;) {
+    auto it = info.virt_page_caps.find(va_base + offset);
+    if (it == info.virt_page_caps.end()) [[unlikely]] {
+      return MM_CODE_E_NOT_MAPPED;
+    }
+
+    size_t page_size = get_page_size(static_cast<int>(unwrap_sysret(sys_virt_page_cap_level(it->second))));
+    if (offset + page_size > size) [[unlikely]] {
+      return MM_CODE_E_ILL_ARGS;
+    }
+
+    pages.push_back(va_base + offset);
+    offset += page_size;
+  }
+
+  for (uintptr_t va : pages) {
+    unmap(id, va);
+  }
+
+  return MM_CODE_S_OK;
+}
+
+int task_table::vgive(id_cap_t id, uintptr_t va_base, size_t size, id_cap_t* ticket) {
+  if (!table.contains(id)) [[unlikely]] {
+    return MM_CODE_E_NOT_ATTACHED;
+  }
+
+  uintptr_t held_va_base;
+  int       result = vmap_range(__this_id_cap, max_page, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, MM_VA_RAMDOM, size, id, va_base, &held_va_base);
+  if (result != MM_CODE_S_OK) [[unlikely]] {
+    return result;
+  }
+
+  *ticket = unwrap_sysret(sys_id_cap_create());
+  held_ranges.emplace(*ticket, held_range { .va_base = held_va_base, .size = size });
+
+  return MM_CODE_S_OK;
+}
+
+int task_table::vtake(id_cap_t id, id_cap_t ticket, int flags, uintptr_t va_base, uintptr_t* act_va_base, size_t* act_size) {
+  if (!table.contains(id)) [[unlikely]] {
+    return MM_CODE_E_NOT_ATTACHED;
+  }
+
+  auto it = held_ranges.find(ticket);
+  if (it == held_ranges.end()) [[unlikely]] {
+    return MM_CODE_E_ILL_ARGS;
+  }
+
+  // A failed take leaves the range held, so the ticket stays good.
+  held_range range  = it->second;
+  int        result = vmap_range(id, max_page, flags, va_base, range.size, __this_id_cap, range.va_base, act_va_base);
+  if (result != MM_CODE_S_OK) [[unlikely]] {
+    return result;
+  }
+
+  id_cap_t held_ticket = it->first;
+  held_ranges.erase(it);
+  sys_cap_destroy(held_ticket);
+
+  *act_size = range.size;
+
+  return MM_CODE_S_OK;
+}
+
 task_info& task_table::get_task_info(id_cap_t id) {
   return table.at(id);
 }
@@ -322,22 +519,9 @@ uintptr_t task_table::random_va(id_cap_t id, int level) {
   assert(table.contains(id));
   assert(level >= KILO_PAGE && level <= max_page);
 
-  task_info& info = table.at(id);
-
-  const size_t    page_size = get_page_size(level);
-  const uintptr_t end_addr  = user_space_end - page_size;
-
-  uintptr_t addr = round_up(get_page_size(MEGA_PAGE) * 10, page_size);
-  while (addr < end_addr) {
-    if (!info.virt_page_caps.contains(addr)) {
-      break;
-    }
-
-    int vp_level = static_cast<int>(unwrap_sysret(sys_virt_page_cap_level(info.virt_page_caps.at(addr))));
-    addr         = round_up(addr + get_page_size(vp_level), page_size);
-  }
+  const size_t page_size = get_page_size(level);
 
-  return addr;
+  return table.at(id).va_ranges.find(page_size, page_size, random_va_start);
 }
 
 page_table_cap_t task_table::walk(id_cap_t id, int level, uintptr_t va_base) {
@@ -365,13 +549,38 @@ page_table_cap_t task_table::walk(id_cap_t id, int level, uintptr_t va_base) {
         return 0;
       }
 
-      info.page_table_caps[lv][base] = child_page_table_cap;
+      info.page_table_caps[lv][base]                  = child_page_table_cap;
+      info.page_table_mem_caps[child_page_table_cap] = mem_cap;
     }
   }
 
+  if (level > KILO_PAGE) {
+    release_page_tables(info, level, va_base);
+  }
+
   return info.page_table_caps[level].at(get_page_table_base_addr(va_base, level));
 }
 
+void task_table::release_page_tables(task_info& info, int level, uintptr_t va_base) {
+  // The range may have held smaller pages before. Their page tables are empty now, but they still occupy the entry.
+  uintptr_t va_end = va_base + get_page_size(level);
+
+  for (int lv = KILO_PAGE; lv < level; ++lv) {
+    auto& page_tables = info.page_table_caps[lv];
+    for (auto it = page_tables.lower_bound(va_base); it != page_tables.end() && it->first < va_end;) {
+      page_table_cap_t parent_page_table = info.page_table_caps[lv + 1].at(get_page_table_base_addr(it->first, lv + 1));
+      sys_page_table_cap_unmap_table(parent_page_table, get_page_table_index(it->first, lv + 1), it->second);
+
+      if (auto mem_it = info.page_table_mem_caps.find(it->second); mem_it != info.page_table_mem_caps.end()) {
+        revoke_mem_cap(mem_it->second);
+        info.page_table_mem_caps.erase(mem_it);
+      }
+
+      it = page_tables.erase(it);
+    }
+  }
+}
+
 int task_table::map(id_cap_t id, int level, int flags, uintptr_t va_base, const void* data, size_t data_size) {
   assert(table.contains(id));
   assert(va_base % get_page_size(level) == 0);
@@ -384,7 +593,7 @@ int task_table::map(id_cap_t id, int level, int flags, uintptr_t va_base, const
     return MM_CODE_E_OVERFLOW;
   }
 
-  if (info.virt_page_caps.contains(va_base)) [[unlikely]] {
+  if (info.virt_page_caps.contains(va_base) || !info.va_ranges.is_free(va_base, get_page_size(level))) [[unlikely]] {
     return MM_CODE_E_ALREADY_MAPPED;
   }
 
@@ -410,6 +619,7 @@ int task_table::map(id_cap_t id, int level, int flags, uintptr_t va_base, const
     uintptr_t va;
     int       result = vpmap(__this_id_cap, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, virt_page_cap, 0, &va);
     if (result != MM_CODE_S_OK) [[unlikely]] {
+      revoke_mem_cap(mem_cap);
       return result;
     }
 
@@ -421,15 +631,22 @@ int task_table::map(id_cap_t id, int level, int flags, uintptr_t va_base, const
 
     result = remap(__this_id_cap, id, level, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, va, va_base);
     if (result != MM_CODE_S_OK) [[unlikely]] {
+      // Undo the vpmap into mm itself, including the allowance it granted for the temporary mapping.
+      unmap(__this_id_cap, va);
+      table.at(__this_id_cap).total_available -= get_page_size(level);
+      revoke_mem_cap(mem_cap);
       return result;
     }
   } else {
     if (sysret_failed(sys_page_table_cap_map_page(page_table_cap, index, readable, writable, executable, virt_page_cap))) {
+      revoke_mem_cap(mem_cap);
       return MM_CODE_E_FAILURE;
     }
   }
 
-  info.virt_page_caps[va_base] = virt_page_cap;
+  info.virt_page_caps[va_base]     = virt_page_cap;
+  info.virt_page_mem_caps[va_base] = mem_cap;
+  info.va_ranges.reserve(va_base, get_page_size(level));
 
   info.total_commit += get_page_size(level);
 
@@ -452,7 +669,7 @@ int task_table::remap(id_cap_t src_id, id_cap_t dst_id, int level, int flags, ui
     return MM_CODE_E_OVERFLOW;
   }
 
-  if (dst_info.virt_page_caps.contains(dst_va_base)) [[unlikely]] {
+  if (dst_info.virt_page_caps.contains(dst_va_base) || !dst_info.va_ranges.is_free(dst_va_base, get_page_size(level))) [[unlikely]] {
     return MM_CODE_E_ALREADY_MAPPED;
   }
 
@@ -477,7 +694,14 @@ int task_table::remap(id_cap_t src_id, id_cap_t dst_id, int level, int flags, ui
   }
 
   dst_info.virt_page_caps[dst_va_base] = virt_page_cap;
+  dst_info.va_ranges.reserve(dst_va_base, get_page_size(level));
   src_info.virt_page_caps.erase(src_va_base);
+  src_info.va_ranges.release(src_va_base, get_page_size(level));
+
+  if (auto it = src_info.virt_page_mem_caps.find(src_va_base); it != src_info.virt_page_mem_caps.end()) {
+    dst_info.virt_page_mem_caps[dst_va_base] = it->second;
+    src_info.virt_page_mem_caps.erase(it);
+  }
 
   dst_info.total_commit += get_page_size(level);
   src_info.total_commit -= get_page_size(level);
@@ -485,6 +709,72 @@ int task_table::remap(id_cap_t src_id, id_cap_t dst_id, int level, int flags, ui
   return MM_CODE_S_OK;
 }
 
+void task_table::unmap(id_cap_t id, uintptr_t va_base) {
+  assert(table.contains(id));
+
+  task_info& info = table.at(id);
+
+  assert(info.virt_page_caps.contains(va_base));
+
+  virt_page_cap_t virt_page_cap = info.virt_page_caps.at(va_base);
+  int             level         = static_cast<int>(unwrap_sysret(sys_virt_page_cap_level(virt_page_cap)));
+  auto&           page_tables   = info.page_table_caps[level];
+
+  if (auto it = page_tables.find(get_page_table_base_addr(va_base, level)); it != page_tables.end()) {
+    sys_page_table_cap_unmap_page(it->second, get_page_table_index(va_base, level), virt_page_cap);
+  }
+  sys_cap_destroy(virt_page_cap);
+
+  if (auto it = info.virt_page_mem_caps.find(va_base); it != info.virt_page_mem_caps.end()) {
+    revoke_mem_cap(it->second);
+    info.virt_page_mem_caps.erase(it);
+  }
+
+  info.virt_page_caps.erase(va_base);
+  info.va_ranges.release(va_base, get_page_size(level));
+
+  info.total_commit -= get_page_size(level);
+}
+
+void task_table::release(task_info& info) {
+  for (const auto& [va_base, virt_page_cap] : info.virt_page_caps) {
+    int   level       = static_cast<int>(unwrap_sysret(sys_virt_page_cap_level(virt_page_cap)));
+    auto& page_tables = info.page_table_caps[level];
+    if (auto it = page_tables.find(get_page_table_base_addr(va_base, level)); it != page_tables.end()) {
+      sys_page_table_cap_unmap_page(it->second, get_page_table_index(va_base, level), virt_page_cap);
+    }
+    sys_cap_destroy(virt_page_cap);
+  }
+
+  for (const auto& [va_base, mem_cap] : info.virt_page_mem_caps) {
+    revoke_mem_cap(mem_cap);
+  }
+
+  // Tear down the intermediate page tables from the leaves up, so that each parent is still alive when its child is unlinked.
+  for (int level = KILO_PAGE; level < max_page; ++level) {
+    int   parent_level       = level + 1;
+    auto& parent_page_tables = info.page_table_caps[parent_level];
+    for (const auto& [va_base, page_table_cap] : info.page_table_caps[level]) {
+      if (auto it = parent_page_tables.find(get_page_table_base_addr(va_base, parent_level)); it != parent_page_tables.end()) {
+        sys_page_table_cap_unmap_table(it->second, get_page_table_index(va_base, parent_level), page_table_cap);
+      }
+      sys_cap_destroy(page_table_cap);
+    }
+  }
+
+  for (const auto& [page_table_cap, mem_cap] : info.page_table_mem_caps) {
+    revoke_mem_cap(mem_cap);
+  }
+
+  sys_cap_destroy(info.page_table_caps[max_page][0]);
+  sys_cap_destroy(info.task_cap);
+
+  info.page_table_caps.clear();
+  info.virt_page_caps.clear();
+  info.virt_page_mem_caps.clear();
+  info.page_table_mem_caps.clear();
+}
+
 int task_table::grow_stack(id_cap_t id, size_t size, const void* data, size_t data_size) {
   if (!table.contains(id)) [[unlikely]] {
     return MM_CODE_E_NOT_ATTACHED;
@@ -556,6 +846,22 @@ int vpremap_task(id_cap_t src_id, id_cap_t dst_id, int flags, virt_page_cap_t vi
   return table.vpremap(src_id, dst_id, flags, virt_page_cap, va_base, act_va_base);
 }
 
+int vmap_range_task(id_cap_t id, int max_level, int flags, uintptr_t va_base, size_t size, id_cap_t src_id, uintptr_t src_va_base, uintptr_t* act_va_base) {
+  return table.vmap_range(id, max_level, flags, va_base, size, src_id, src_va_base, act_va_base);
+}
+
+int vunmap_task(id_cap_t id, uintptr_t va_base, size_t size) {
+  return table.vunmap(id, va_base, size);
+}
+
+int vgive_task(id_cap_t id, uintptr_t va_base, size_t size, id_cap_t* ticket) {
+  return table.vgive(id, va_base, size, ticket);
+}
+
+int vtake_task(id_cap_t id, id_cap_t ticket, int flags, uintptr_t va_base, uintptr_t* act_va_base, size_t* act_size) {
+  return table.vtake(id, ticket, flags, va_base, act_va_base, act_size);
+}
+
 int grow_stack(id_cap_t id, size_t size) {
   return table.grow_stack(id, size, nullptr, 0);
 }
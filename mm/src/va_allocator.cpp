@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cassert>
+#include <mm/va_allocator.h>
+
+va_allocator::va_allocator(): domain_start(0), domain_end(0) { }
+
+va_allocator::va_allocator(uintptr_t start, uintptr_t end): domain_start(start), domain_end(end) {
+  assert(start <= end);
+
+  if (start < end) {
+    insert(start, end - start);
+  }
+}
+
+uintptr_t va_allocator::find(size_t size, size_t alignment, uintptr_t min_base) const {
+  assert(size > 0);
+  assert(alignment > 0);
+
+  // Every range of at least `size + alignment - 1` bytes above min_base is guaranteed to hold an aligned block.
+  // Smaller candidates are only visited until the first such range, so the search stays logarithmic in practice.
+  for (auto it = free_sizes.lower_bound({ size, 0 }); it != free_sizes.end(); ++it) {
+    const auto& [range_size, range_base] = *it;
+
+    uintptr_t base = (std::max(range_base, min_base) + alignment - 1) / alignment * alignment;
+    if (base + size <= range_base + range_size) {
+      return base;
+    }
+  }
+
+  return 0;
+}
+
+bool va_allocator::is_free(uintptr_t base, size_t size) const {
+  uintptr_t start = std::max(base, domain_start);
+  uintptr_t end   = std::min(base + size, domain_end);
+
+  if (start >= end) {
+    return true;
+  }
+
+  auto it = free_ranges.upper_bound(start);
+  if (it == free_ranges.begin()) {
+    return false;
+  }
+  --it;
+
+  return it->first <= start && end <= it->first + it->second;
+}
+
+bool va_allocator::reserve(uintptr_t base, size_t size) {
+  uintptr_t start = std::max(base, domain_start);
+  uintptr_t end   = std::min(base + size, domain_end);
+
+  if (start >= end) {
+    return true;
+  }
+
+  auto it = free_ranges.upper_bound(start);
+  if (it == free_ranges.begin()) [[unlikely]] {
+    return false;
+  }
+  --it;
+
+  uintptr_t range_base = it->first;
+  uintptr_t range_end  = it->first + it->second;
+
+  if (range_base > start || end > range_end) [[unlikely]] {
+    return false;
+  }
+
+  erase(it);
+
+  if (range_base < start) {
+    insert(range_base, start - range_base);
+  }
+
+  if (end < range_end) {
+    insert(end, range_end - end);
+  }
+
+  return true;
+}
+
+void va_allocator::release(uintptr_t base, size_t size) {
+  uintptr_t start = std::max(base, domain_start);
+  uintptr_t end   = std::min(base + size, domain_end);
+
+  if (start >= end) {
+    return;
+  }
+
+  auto next = free_ranges.lower_bound(start);
+  if (next != free_ranges.end() && next->first == end) {
+    end = next->first + next->second;
+    erase(next);
+  }
+
+  auto prev = free_ranges.lower_bound(start);
+  if (prev != free_ranges.begin()) {
+    --prev;
+    if (prev->first + prev->second == start) {
+      start = prev->first;
+      erase(prev);
+    }
+  }
+
+  insert(start, end - start);
+}
+
+void va_allocator::insert(uintptr_t base, size_t size) {
+  free_ranges.emplace(base, size);
+  free_sizes.emplace(size, base);
+}
+
+void va_allocator::erase(std::map<uintptr_t, size_t>::iterator it) {
+  free_sizes.erase({ it->second, it->first });
+  free_ranges.erase(it);
+}
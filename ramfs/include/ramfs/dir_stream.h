@@ -7,7 +7,7 @@
 
 class dir_stream {
   std::reference_wrapper<directory> dir;
-  std::streampos                    pos;
+  directory::cursor                 cur;
 
 public:
   dir_stream(directory& dir);
@@ -18,6 +18,7 @@ public:
   dir_stream& operator=(dir_stream&&)      = default;
 
   [[nodiscard]] std::streamsize read(fs_file_info* buffer);
+  [[nodiscard]] std::streamsize readdir(char* buffer, std::streamsize size);
 };
 
 #endif // RAMFS_DIR_STREAM_H_
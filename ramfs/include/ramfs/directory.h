@@ -16,6 +16,19 @@ class directory {
   std::map<std::string, directory, std::less<>> dirs;
   std::map<std::string, file, std::less<>>      files;
 
+public:
+  // A listing position: directories come first, then files, each resumed after the last name returned.
+  // Resuming by name keeps the position valid while entries are added or removed.
+  struct cursor {
+    bool        in_files = false;
+    bool        started  = false;
+    std::string last;
+  };
+
+private:
+  template<typename F>
+  void walk(cursor& cur, F&& visit) const;
+
 public:
   directory(std::string_view abs_path);
 
@@ -34,12 +47,13 @@ public:
   [[nodiscard]] const directory& get_dir(std::string_view name) const;
   [[nodiscard]] const file&      get_file(std::string_view name) const;
 
-  [[nodiscard]] std::streamsize read(std::streampos pos, fs_file_info* buffer);
+  [[nodiscard]] bool            read(cursor& cur, fs_file_info* buffer) const;
+  [[nodiscard]] std::streamsize read(cursor& cur, char* buffer, std::streamsize size) const;
 
   [[nodiscard]] std::optional<std::reference_wrapper<directory>> find_directory(std::string_view path);
   [[nodiscard]] std::optional<std::reference_wrapper<file>>      find_file(std::string_view path);
   [[nodiscard]] std::optional<std::reference_wrapper<directory>> create_directories(std::string_view path);
-  [[nodiscard]] std::optional<std::reference_wrapper<file>>      create_file(std::string_view path, std::vector<char>&& data = {});
+  [[nodiscard]] std::optional<std::reference_wrapper<file>>      create_file(std::string_view path, std::string_view image = {});
   [[nodiscard]] bool                                             remove(std::string_view path);
 };
 
@@ -1,16 +1,34 @@
 #ifndef RAMFS_FILE_H_
 #define RAMFS_FILE_H_
 
+#include <cstdint>
+#include <map>
+#include <ramfs/page_pool.h>
 #include <string>
 #include <string_view>
-#include <vector>
 
 class file {
-  std::string       abs_path;
-  std::vector<char> data;
+public:
+  static constexpr size_t page_size = 0x1000;
+
+private:
+  // A page either still points into the read-only boot image or owns a private pool page made on the first write to it.
+  struct page {
+    const char* data;
+    page_ptr    private_data;
+  };
+
+  std::string            abs_path;
+  std::string_view       image;
+  std::map<size_t, page> pages;
+  size_t                 file_size;
+  uint64_t               version;
+
+  [[nodiscard]] char* make_private(size_t index);
+  [[nodiscard]] bool  prepare_growth(size_t new_size);
 
 public:
-  file(std::string_view abs_path, std::vector<char>&& data);
+  file(std::string_view abs_path, std::string_view image = {});
 
   file(const file&)            = delete;
   file& operator=(const file&) = delete;
@@ -20,9 +38,12 @@ public:
   [[nodiscard]] const std::string& get_abs_path() const;
   [[nodiscard]] std::string_view   get_name() const;
   [[nodiscard]] std::streamsize    size() const;
+  [[nodiscard]] uint64_t           get_version() const;
 
+  [[nodiscard]] const char*     get_page(size_t index) const;
   [[nodiscard]] std::streamsize read(std::streampos pos, char* buffer, std::streamsize size);
   [[nodiscard]] std::streamsize write(std::streampos pos, std::string_view data);
+  [[nodiscard]] bool            truncate(std::streamsize size);
 };
 
 #endif // RAMFS_FILE_H_
@@ -21,6 +21,7 @@ public:
   [[nodiscard]] std::streamsize write(std::string_view data);
   [[nodiscard]] std::streampos  seek(std::streamoff off, std::ios_base::seekdir dir);
   [[nodiscard]] std::streampos  tell() const;
+  [[nodiscard]] class file&     get_file() const;
 };
 
 #endif // RAMFS_STREAM_H_
@@ -8,14 +8,22 @@
 
 [[nodiscard]] bool ramfs_init(uintptr_t ramfs_va_base);
 
-[[nodiscard]] int ramfs_get_info(std::string_view path, fs_file_info& dst);
-[[nodiscard]] int ramfs_create(std::string_view path, int type);
-[[nodiscard]] int ramfs_remove(std::string_view path);
-[[nodiscard]] int ramfs_open(std::string_view path, id_cap_t& fd);
-[[nodiscard]] int ramfs_close(id_cap_t fd);
-[[nodiscard]] int ramfs_read(id_cap_t fd, char* buffer, std::streamsize size, std::streamsize& act_size);
-[[nodiscard]] int ramfs_write(id_cap_t fd, std::string_view data, std::streamsize& act_size);
-[[nodiscard]] int ramfs_seek(id_cap_t fd, std::streamoff off, std::ios_base::seekdir dir);
-[[nodiscard]] int ramfs_tell(id_cap_t fd, std::streampos& pos);
+[[nodiscard]] int      ramfs_get_info(std::string_view path, fs_file_info& dst);
+[[nodiscard]] int      ramfs_create(std::string_view path, int type);
+[[nodiscard]] int      ramfs_remove(std::string_view path);
+[[nodiscard]] int      ramfs_open(std::string_view path, id_cap_t& fd, fs_file_info& info);
+[[nodiscard]] id_cap_t ramfs_open_channel(id_cap_t fd);
+[[nodiscard]] bool     ramfs_check_channel(id_cap_t fd, id_cap_t channel);
+[[nodiscard]] int      ramfs_close(id_cap_t fd);
+[[nodiscard]] int      ramfs_read(id_cap_t fd, char* buffer, std::streamsize size, std::streamsize& act_size);
+[[nodiscard]] int      ramfs_write(id_cap_t fd, std::string_view data, std::streamsize& act_size);
+[[nodiscard]] int      ramfs_seek(id_cap_t fd, std::streamoff off, std::ios_base::seekdir dir);
+[[nodiscard]] int      ramfs_tell(id_cap_t fd, std::streampos& pos);
+[[nodiscard]] int      ramfs_mmap(id_cap_t fd, std::streamoff offset, size_t size, id_cap_t& ticket, size_t& act_size);
+[[nodiscard]] int      ramfs_truncate(id_cap_t fd, std::streamsize size);
+[[nodiscard]] int      ramfs_readdir(id_cap_t fd, char* buffer, std::streamsize size, std::streamsize& act_size);
+[[nodiscard]] int      ramfs_pread(id_cap_t fd, std::streampos pos, char* buffer, std::streamsize size, std::streamsize& act_size);
+[[nodiscard]] int      ramfs_pwrite(id_cap_t fd, std::streampos pos, std::string_view data, std::streamsize& act_size);
+[[nodiscard]] int      ramfs_readfile(std::string_view path, char* buffer, std::streamsize size, std::streamsize& act_size, size_t& file_size);
 
 #endif // RAMFS_FS_H_
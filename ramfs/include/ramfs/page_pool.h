@@ -0,0 +1,14 @@
+#ifndef RAMFS_PAGE_POOL_H_
+#define RAMFS_PAGE_POOL_H_
+
+#include <memory>
+
+struct page_deleter {
+  void operator()(char* page) const noexcept;
+};
+
+using page_ptr = std::unique_ptr<char[], page_deleter>;
+
+[[nodiscard]] page_ptr alloc_page();
+
+#endif // RAMFS_PAGE_POOL_H_
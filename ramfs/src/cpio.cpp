@@ -35,7 +35,7 @@ bool load_cpio(directory& root_dir, const char* cpio_data) {
     if (strcmp(name, CPIO_EOF_TAG) == 0) {
       break;
     } else {
-      if (!root_dir.create_file(std::string_view(name, name_size - 1), std::vector(data, data + data_size))) [[unlikely]] {
+      if (!root_dir.create_file(std::string_view(name, name_size - 1), std::string_view(data, data_size))) [[unlikely]] {
         return false;
       }
 
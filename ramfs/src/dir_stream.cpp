@@ -1,13 +1,15 @@
 #include <ramfs/dir_stream.h>
 
-dir_stream::dir_stream(directory& dir): dir(dir), pos(0) { }
+dir_stream::dir_stream(directory& dir): dir(dir) { }
 
 std::streamsize dir_stream::read(fs_file_info* buffer) {
-  if (dir.get().read(pos, buffer) == 0) {
+  if (!dir.get().read(cur, buffer)) {
     return 0;
   }
 
-  pos += 1;
-
   return sizeof(fs_file_info);
 }
+
+std::streamsize dir_stream::readdir(char* buffer, std::streamsize size) {
+  return dir.get().read(cur, buffer, size);
+}
@@ -1,5 +1,32 @@
+#include <cstring>
 #include <ramfs/directory.h>
 
+namespace {
+  uint8_t entry_type(const directory&) {
+    return FS_FT_DIR;
+  }
+
+  uint8_t entry_type(const file&) {
+    return FS_FT_REG;
+  }
+
+  size_t entry_size(const directory&) {
+    return 0;
+  }
+
+  size_t entry_size(const file& f) {
+    return f.size();
+  }
+
+  uint64_t entry_version(const directory&) {
+    return 0;
+  }
+
+  uint64_t entry_version(const file& f) {
+    return f.get_version();
+  }
+} // namespace
+
 directory::directory(std::string_view abs_path): abs_path(abs_path) { }
 
 const std::string& directory::get_abs_path() const {
@@ -41,36 +68,87 @@ const file& directory::get_file(std::string_view name) const {
   return files.find(name)->second;
 }
 
-std::streamsize directory::read(std::streampos pos, fs_file_info* buffer) {
-  size_t total_size = dirs.size() + files.size();
+template<typename F>
+void directory::walk(cursor& cur, F&& visit) const {
+  // Returns whether the map was exhausted, and moves the cursor past the last entry visited.
+  auto scan = [&](const auto& entries) {
+    auto iter = cur.started ? entries.upper_bound(cur.last) : entries.begin();
+    auto last = entries.end();
+
+    for (; iter != entries.end(); ++iter) {
+      if (!visit(iter->first, iter->second)) {
+        break;
+      }
+      last = iter;
+    }
 
-  if (pos < 0 || total_size <= static_cast<size_t>(pos)) [[unlikely]] {
-    return 0;
+    if (last != entries.end()) {
+      cur.last    = last->first;
+      cur.started = true;
+    }
+
+    return iter == entries.end();
+  };
+
+  if (!cur.in_files) {
+    if (!scan(dirs)) {
+      return;
+    }
+
+    cur.in_files = true;
+    cur.started  = false;
   }
 
-  if (static_cast<size_t>(pos) < dirs.size()) {
-    auto iter = dirs.begin();
-    std::advance(iter, static_cast<size_t>(pos));
+  scan(files);
+}
 
-    buffer->file_size      = 0;
-    buffer->file_type      = FS_FT_DIR;
-    buffer->file_name_size = iter->first.size();
-    iter->first.copy(buffer->file_name, sizeof(buffer->file_name) - 1);
-    buffer->file_name[buffer->file_name_size] = '\0';
+bool directory::read(cursor& cur, fs_file_info* buffer) const {
+  bool found = false;
 
-    return 1;
-  } else {
-    auto iter = files.begin();
-    std::advance(iter, static_cast<size_t>(pos) - dirs.size());
+  walk(cur, [&](const std::string& name, const auto& entry) {
+    if (found) {
+      return false;
+    }
+
+    buffer->file_size    = entry_size(entry);
+    buffer->file_version = entry_version(entry);
+    buffer->file_type    = entry_type(entry);
 
-    buffer->file_size      = iter->second.size();
-    buffer->file_type      = FS_FT_REG;
-    buffer->file_name_size = iter->first.size();
-    iter->first.copy(buffer->file_name, sizeof(buffer->file_name) - 1);
+    buffer->file_name_size = name.size();
+    name.copy(buffer->file_name, sizeof(buffer->file_name) - 1);
     buffer->file_name[buffer->file_name_size] = '\0';
 
-    return 1;
-  }
+    found = true;
+    return true;
+  });
+
+  return found;
+}
+
+std::streamsize directory::read(cursor& cur, char* buffer, std::streamsize size) const {
+  char* ptr = buffer;
+  char* end = buffer + size;
+
+  walk(cur, [&](const std::string& name, const auto& entry) {
+    size_t dirent_size = FS_DIRENT_SIZE(name.size());
+    if (static_cast<size_t>(end - ptr) < dirent_size) {
+      return false;
+    }
+
+    fs_dirent dirent {
+      .file_type      = entry_type(entry),
+      .file_name_size = static_cast<uint8_t>(name.size()),
+    };
+
+    memcpy(ptr, &dirent, sizeof(dirent));
+    memcpy(ptr + sizeof(dirent), name.data(), name.size());
+    ptr[sizeof(dirent) + name.size()] = '\0';
+    ptr += dirent_size;
+
+    return true;
+  });
+
+  return ptr - buffer;
 }
 
 std::optional<std::reference_wrapper<directory>> directory::find_directory(std::string_view path) {
@@ -182,7 +260,7 @@ std::optional<std::reference_wrapper<directory>> directory::create_directories(s
   return cur;
 }
 
-std::optional<std::reference_wrapper<file>> directory::create_file(std::string_view path, std::vector<char>&& data) {
+std::optional<std::reference_wrapper<file>> directory::create_file(std::string_view path, std::string_view image) {
   if (path.empty() || path.front() == '/' || path.back() == '/') [[unlikely]] {
     return std::nullopt;
   }
@@ -209,7 +287,7 @@ std::optional<std::reference_wrapper<file>> directory::create_file(std::string_v
     return std::nullopt;
   }
 
-  parent.get().files.emplace(name, file(path, std::move(data)));
+  parent.get().files.emplace(name, file(path, image));
 
   return parent.get().get_file(name);
 }
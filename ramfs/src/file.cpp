@@ -1,7 +1,21 @@
+#include <algorithm>
+#include <cstring>
 #include <ramfs/file.h>
 #include <utility>
 
-file::file(std::string_view abs_path, std::vector<char>&& data): abs_path(abs_path), data(std::move(data)) { }
+namespace {
+  // Versions are unique across files, so a file that is removed and created again never repeats one.
+  uint64_t next_version() {
+    static uint64_t version = 0;
+    return ++version;
+  }
+} // namespace
+
+file::file(std::string_view abs_path, std::string_view image): abs_path(abs_path), image(image), file_size(image.size()), version(next_version()) {
+  for (size_t offset = 0; offset < image.size(); offset += page_size) {
+    pages.emplace_hint(pages.end(), offset / page_size, page { image.data() + offset, nullptr });
+  }
+}
 
 const std::string& file::get_abs_path() const {
   return abs_path;
@@ -19,25 +33,149 @@ std::string_view file::get_name() const {
 }
 
 std::streamsize file::size() const {
-  return data.size();
+  return file_size;
+}
+
+uint64_t file::get_version() const {
+  return version;
+}
+
+const char* file::get_page(size_t index) const {
+  auto it = pages.find(index);
+  if (it == pages.end()) {
+    return nullptr;
+  }
+
+  return it->second.data;
 }
 
 std::streamsize file::read(std::streampos pos, char* buffer, std::streamsize size) {
-  if (pos < 0 || static_cast<size_t>(pos) >= data.size()) {
+  if (pos < 0 || static_cast<size_t>(pos) >= file_size) {
     return 0;
   }
 
-  const auto act_size = std::min(size, static_cast<std::streamsize>(data.size() - pos));
-  std::copy_n(data.data() + pos, act_size, buffer);
+  const size_t act_size = std::min(static_cast<size_t>(size), file_size - static_cast<size_t>(pos));
+
+  size_t offset = pos;
+  size_t end    = offset + act_size;
+  auto   it     = pages.lower_bound(offset / page_size);
+
+  while (offset < end) {
+    size_t index       = offset / page_size;
+    size_t page_offset = offset % page_size;
+    size_t len         = std::min(page_size - page_offset, end - offset);
+
+    if (it != pages.end() && it->first == index) {
+      memcpy(buffer, it->second.data + page_offset, len);
+      ++it;
+    } else {
+      memset(buffer, 0, len);
+    }
+
+    buffer += len;
+    offset += len;
+  }
+
   return act_size;
 }
 
 std::streamsize file::write(std::streampos pos, std::string_view data) {
-  if (pos < 0 || static_cast<size_t>(pos) + data.size() >= this->data.size()) {
-    this->data.resize(static_cast<size_t>(pos) + data.size());
+  if (pos < 0 || data.empty()) [[unlikely]] {
+    return 0;
+  }
+
+  size_t      offset = pos;
+  size_t      end    = offset + data.size();
+  const char* ptr    = data.data();
+
+  if (!prepare_growth(end)) [[unlikely]] {
+    return 0;
+  }
+
+  while (offset < end) {
+    size_t page_offset = offset % page_size;
+    size_t len         = std::min(page_size - page_offset, end - offset);
+
+    char* page_data = make_private(offset / page_size);
+    if (page_data == nullptr) [[unlikely]] {
+      break;
+    }
+
+    memcpy(page_data + page_offset, ptr, len);
+    ptr += len;
+    offset += len;
+  }
+
+  file_size = std::max(file_size, offset);
+  version   = next_version();
+
+  return offset - static_cast<size_t>(pos);
+}
+
+bool file::truncate(std::streamsize size) {
+  if (size < 0) [[unlikely]] {
+    return false;
+  }
+
+  size_t new_size = size;
+
+  if (new_size < file_size) {
+    pages.erase(pages.lower_bound((new_size + page_size - 1) / page_size), pages.end());
+
+    // Clear the tail of the last page so that growing the file again reads zeros there.
+    if (new_size % page_size != 0 && pages.contains(new_size / page_size)) {
+      char* page_data = make_private(new_size / page_size);
+      if (page_data == nullptr) [[unlikely]] {
+        return false;
+      }
+      memset(page_data + new_size % page_size, 0, page_size - new_size % page_size);
+    }
+  } else if (!prepare_growth(new_size)) [[unlikely]] {
+    return false;
   }
 
-  std::copy_n(data.data(), data.size(), this->data.data() + pos);
+  file_size = new_size;
+  version   = next_version();
+
+  return true;
+}
+
+bool file::prepare_growth(size_t new_size) {
+  size_t index = file_size / page_size;
+
+  // The bytes behind the end of a borrowed tail page belong to the next cpio entry, so the page must be private before they become visible.
+  if (new_size > file_size && file_size % page_size != 0) {
+    auto it = pages.find(index);
+    if (it != pages.end() && it->second.private_data == nullptr) {
+      return make_private(index) != nullptr;
+    }
+  }
+
+  return true;
+}
+
+char* file::make_private(size_t index) {
+  auto it = pages.find(index);
+
+  if (it == pages.end()) {
+    page_ptr private_data = alloc_page();
+    if (private_data == nullptr) [[unlikely]] {
+      return nullptr;
+    }
+
+    const char* data = private_data.get();
+    it               = pages.emplace(index, page { data, std::move(private_data) }).first;
+  } else if (it->second.private_data == nullptr) {
+    page_ptr private_data = alloc_page();
+    if (private_data == nullptr) [[unlikely]] {
+      return nullptr;
+    }
+
+    size_t image_offset = index * page_size;
+    memcpy(private_data.get(), it->second.data, std::min(page_size, image.size() - image_offset));
+    it->second.data         = private_data.get();
+    it->second.private_data = std::move(private_data);
+  }
 
-  return data.size();
+  return it->second.private_data.get();
 }
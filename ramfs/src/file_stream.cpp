@@ -33,3 +33,7 @@ std::streampos file_stream::seek(std::streamoff off, std::ios_base::seekdir dir)
 std::streampos file_stream::tell() const {
   return pos;
 }
+
+file& file_stream::get_file() const {
+  return file.get();
+}
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <crt/global.h>
 #include <cstdlib>
+#include <cstring>
 #include <libcaprese/cxx/id_map.h>
 #include <optional>
 #include <ramfs/cpio.h>
@@ -10,17 +12,20 @@
 #include <ramfs/fs.h>
 #include <ramfs/server.h>
 #include <service/fs.h>
+#include <service/mm.h>
 
 namespace {
   std::optional<directory>     root_directory;
   caprese::id_map<file_stream> file_streams;
   caprese::id_map<dir_stream>  dir_streams;
+  caprese::id_map<id_cap_t>    channels;
 
   int get_file_info(file& file, fs_file_info& dst) {
     std::string_view name = file.get_name();
 
     dst.file_type                     = FS_FT_REG;
     dst.file_size                     = file.size();
+    dst.file_version                  = file.get_version();
     dst.file_name_size                = name.copy(dst.file_name, FS_FILE_NAME_SIZE_MAX - 1, 0);
     dst.file_name[dst.file_name_size] = '\0';
 
@@ -32,6 +37,7 @@ namespace {
 
     dst.file_type                     = FS_FT_DIR;
     dst.file_size                     = 0;
+    dst.file_version                  = 0;
     dst.file_name_size                = name.copy(dst.file_name, FS_FILE_NAME_SIZE_MAX - 1, 0);
     dst.file_name[dst.file_name_size] = '\0';
 
@@ -99,32 +105,47 @@ int ramfs_remove(std::string_view path) {
   return FS_CODE_S_OK;
 }
 
-int ramfs_open(std::string_view path, id_cap_t& fd) {
+int ramfs_open(std::string_view path, id_cap_t& fd, fs_file_info& info) {
   auto file = root_directory->find_file(path);
   if (file) {
     fd = unwrap_sysret(sys_id_cap_create());
     file_streams.emplace(fd, *file);
-    return FS_CODE_S_OK;
+    return get_file_info(*file, info);
   }
 
   auto dir = root_directory->find_directory(path);
   if (dir) {
     fd = unwrap_sysret(sys_id_cap_create());
     dir_streams.emplace(fd, *dir);
-    return FS_CODE_S_OK;
+    return get_dir_info(*dir, info);
   }
 
   file = root_directory->create_file(path, {});
   if (file) {
     fd = unwrap_sysret(sys_id_cap_create());
     file_streams.emplace(fd, *file);
-    return FS_CODE_S_OK;
+    return get_file_info(*file, info);
   }
 
   return FS_CODE_E_NO_SUCH_FILE;
 }
 
+id_cap_t ramfs_open_channel(id_cap_t fd) {
+  id_cap_t channel = unwrap_sysret(sys_id_cap_create());
+  channels.emplace(fd, channel);
+  return channel;
+}
+
+bool ramfs_check_channel(id_cap_t fd, id_cap_t channel) {
+  return channels.contains(fd) && unwrap_sysret(sys_id_cap_compare(channels.at(fd), channel)) == 0;
+}
+
 int ramfs_close(id_cap_t fd) {
+  if (channels.contains(fd)) {
+    sys_cap_destroy(channels.at(fd));
+    channels.erase(fd);
+  }
+
   if (file_streams.contains(fd)) {
     file_streams.erase(fd);
     return FS_CODE_S_OK;
@@ -201,3 +222,135 @@ int ramfs_tell(id_cap_t fd, std::streampos& pos) {
 
   return FS_CODE_S_OK;
 }
+
+int ramfs_mmap(id_cap_t fd, std::streamoff offset, size_t size, id_cap_t& ticket, size_t& act_size) {
+  if (!file_streams.contains(fd)) [[unlikely]] {
+    return FS_CODE_E_ILL_ARGS;
+  }
+
+  file& file = file_streams.at(fd).get_file();
+
+  if (offset < 0 || offset % KILO_PAGE_SIZE != 0 || offset > file.size()) [[unlikely]] {
+    return FS_CODE_E_ILL_ARGS;
+  }
+
+  size_t rem_size = file.size() - offset;
+  if (size == 0 || size > rem_size) {
+    size = rem_size;
+  }
+
+  if (size == 0) [[unlikely]] {
+    return FS_CODE_E_EOF;
+  }
+
+  size_t map_size = (size + KILO_PAGE_SIZE - 1) / KILO_PAGE_SIZE * KILO_PAGE_SIZE;
+
+  // Fill the pages here and give the whole range to mm, which moves it into the client when the client takes it.
+  uintptr_t stage_va = mm_vmap_range(__mm_id_cap, MEGA_PAGE, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, MM_VA_RAMDOM, map_size, 0, 0);
+  if (stage_va == 0) [[unlikely]] {
+    return FS_CODE_E_FAILURE;
+  }
+
+  char* stage = reinterpret_cast<char*>(stage_va);
+  for (size_t page_offset = 0; page_offset < map_size; page_offset += file::page_size) {
+    const char* page_data = file.get_page((offset + page_offset) / file::page_size);
+    size_t      len       = 0;
+    if (page_data != nullptr) {
+      len = std::min(file::page_size, size - page_offset);
+      memcpy(stage + page_offset, page_data, len);
+    }
+    memset(stage + page_offset + len, 0, file::page_size - len);
+  }
+
+  ticket = mm_vgive(__mm_id_cap, stage_va, map_size);
+  if (ticket == 0) [[unlikely]] {
+    mm_vunmap(__mm_id_cap, stage_va, map_size);
+    return FS_CODE_E_FAILURE;
+  }
+
+  act_size = size;
+
+  return FS_CODE_S_OK;
+}
+
+int ramfs_truncate(id_cap_t fd, std::streamsize size) {
+  if (!file_streams.contains(fd)) [[unlikely]] {
+    return FS_CODE_E_ILL_ARGS;
+  }
+
+  if (!file_streams.at(fd).get_file().truncate(size)) [[unlikely]] {
+    return FS_CODE_E_FAILURE;
+  }
+
+  return FS_CODE_S_OK;
+}
+
+int ramfs_readdir(id_cap_t fd, char* buffer, std::streamsize size, std::streamsize& act_size) {
+  if (file_streams.contains(fd)) [[unlikely]] {
+    return FS_CODE_E_TYPE;
+  }
+
+  if (!dir_streams.contains(fd)) [[unlikely]] {
+    return FS_CODE_E_ILL_ARGS;
+  }
+
+  if (size < static_cast<std::streamsize>(FS_DIRENT_SIZE(FS_FILE_NAME_SIZE_MAX))) [[unlikely]] {
+    return FS_CODE_E_ILL_ARGS;
+  }
+
+  act_size = dir_streams.at(fd).readdir(buffer, size);
+
+  if (act_size == 0) [[unlikely]] {
+    return FS_CODE_E_EOF;
+  }
+
+  return FS_CODE_S_OK;
+}
+
+int ramfs_pread(id_cap_t fd, std::streampos pos, char* buffer, std::streamsize size, std::streamsize& act_size) {
+  if (dir_streams.contains(fd)) [[unlikely]] {
+    return FS_CODE_E_TYPE;
+  }
+
+  if (!file_streams.contains(fd)) [[unlikely]] {
+    return FS_CODE_E_ILL_ARGS;
+  }
+
+  act_size = file_streams.at(fd).get_file().read(pos, buffer, size);
+
+  if (size > act_size) [[unlikely]] {
+    return FS_CODE_E_EOF;
+  }
+
+  return FS_CODE_S_OK;
+}
+
+int ramfs_pwrite(id_cap_t fd, std::streampos pos, std::string_view data, std::streamsize& act_size) {
+  if (dir_streams.contains(fd)) [[unlikely]] {
+    return FS_CODE_E_TYPE;
+  }
+
+  if (!file_streams.contains(fd)) [[unlikely]] {
+    return FS_CODE_E_ILL_ARGS;
+  }
+
+  act_size = file_streams.at(fd).get_file().write(pos, data);
+
+  if (data.size() > static_cast<size_t>(act_size)) [[unlikely]] {
+    return FS_CODE_E_EOF;
+  }
+
+  return FS_CODE_S_OK;
+}
+
+int ramfs_readfile(std::string_view path, char* buffer, std::streamsize size, std::streamsize& act_size, size_t& file_size) {
+  auto file = root_directory->find_file(path);
+  if (!file) {
+    return root_directory->find_directory(path) ? FS_CODE_E_TYPE : FS_CODE_E_NO_SUCH_FILE;
+  }
+
+  act_size  = file->get().read(0, buffer, size);
+  file_size = file->get().size();
+
+  return FS_CODE_S_OK;
+}
@@ -0,0 +1,41 @@
+#include <crt/global.h>
+#include <cstring>
+#include <libcaprese/syscall.h>
+#include <ramfs/page_pool.h>
+#include <service/mm.h>
+#include <vector>
+
+namespace {
+  constexpr size_t pool_grow_size = 16 * KILO_PAGE_SIZE;
+
+  std::vector<char*> free_pages;
+
+  bool grow_pool() {
+    uintptr_t va_base = mm_vmap_range(__mm_id_cap, KILO_PAGE, MM_VMAP_FLAG_READ | MM_VMAP_FLAG_WRITE, MM_VA_RAMDOM, pool_grow_size, 0, 0);
+    if (va_base == 0) [[unlikely]] {
+      return false;
+    }
+
+    for (uintptr_t va = va_base + pool_grow_size; va > va_base; va -= KILO_PAGE_SIZE) {
+      free_pages.push_back(reinterpret_cast<char*>(va - KILO_PAGE_SIZE));
+    }
+
+    return true;
+  }
+} // namespace
+
+void page_deleter::operator()(char* page) const noexcept {
+  free_pages.push_back(page);
+}
+
+page_ptr alloc_page() {
+  if (free_pages.empty() && !grow_pool()) [[unlikely]] {
+    return nullptr;
+  }
+
+  char* page = free_pages.back();
+  free_pages.pop_back();
+  memset(page, 0, KILO_PAGE_SIZE);
+
+  return page_ptr(page);
+}
@@ -1,5 +1,6 @@
 #include <crt/global.h>
 #include <cstdio>
+#include <cstring>
 #include <fs/ipc.h>
 #include <libcaprese/ipc.h>
 #include <libcaprese/syscall.h>
@@ -80,8 +81,9 @@ namespace {
       return;
     }
 
-    id_cap_t fd;
-    int      result = ramfs_open(c_path, fd);
+    id_cap_t     fd;
+    fs_file_info info;
+    int          result = ramfs_open(c_path, fd, info);
 
     destroy_ipc_message(msg);
     set_ipc_data(msg, 0, result);
@@ -90,26 +92,24 @@ namespace {
       return;
     }
 
+    id_cap_t channel = ramfs_open_channel(fd);
+
     set_ipc_cap(msg, 1, unwrap_sysret(sys_id_cap_copy(fd)), false);
+    set_ipc_cap(msg, 2, unwrap_sysret(sys_id_cap_copy(channel)), false);
+    set_ipc_data_array(msg, 3, &info, sizeof(info));
   }
 
   void close(message_t* msg) {
     assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_CLOSE);
 
-    id_cap_t id = get_ipc_cap(msg, 1);
-    if (unwrap_sysret(sys_cap_type(id)) != CAP_ID) [[unlikely]] {
-      destroy_ipc_message(msg);
-      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
-      return;
-    }
-
-    if (unwrap_sysret(sys_id_cap_compare(id, ramfs_id_cap)) != 0) [[unlikely]] {
+    id_cap_t fd = get_ipc_cap(msg, 2);
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
       destroy_ipc_message(msg);
       set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
       return;
     }
 
-    int result = ramfs_close(id);
+    int result = ramfs_close(fd);
 
     destroy_ipc_message(msg);
     set_ipc_data(msg, 0, result);
@@ -243,42 +243,348 @@ namespace {
     set_ipc_data(msg, 1, pos);
   }
 
+  void mmap(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_MMAP);
+
+    id_cap_t fd = get_ipc_cap(msg, 2);
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::streamoff offset = get_ipc_data(msg, 3);
+    size_t         size   = get_ipc_data(msg, 4);
+
+    id_cap_t ticket;
+    size_t   act_size;
+    int      result = ramfs_mmap(fd, offset, size, ticket, act_size);
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+
+    if (result != FS_CODE_S_OK) [[unlikely]] {
+      return;
+    }
+
+    set_ipc_cap(msg, 1, ticket, false);
+    set_ipc_data(msg, 2, act_size);
+  }
+
+  void truncate(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_TRUNCATE);
+
+    id_cap_t fd = get_ipc_cap(msg, 2);
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::streamsize size = get_ipc_data(msg, 3);
+
+    int result = ramfs_truncate(fd, size);
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+  }
+
+  void readdir(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_READDIR);
+
+    id_cap_t fd = get_ipc_cap(msg, 2);
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    size_t len = get_ipc_data(msg, 3);
+    if (len > FS_READ_MAX_SIZE) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::unique_ptr<char[]> buffer = std::make_unique<char[]>(len);
+    std::streamsize         act_size;
+    int                     result = ramfs_readdir(fd, buffer.get(), len, act_size);
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+
+    if (result != FS_CODE_S_OK) [[unlikely]] {
+      return;
+    }
+
+    set_ipc_data(msg, 1, act_size);
+    set_ipc_data_array(msg, 2, buffer.get(), act_size);
+  }
+
+  void pread(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_PREAD);
+
+    id_cap_t fd = get_ipc_cap(msg, 2);
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::streampos pos = get_ipc_data(msg, 3);
+    size_t         len = get_ipc_data(msg, 4);
+    if (len > FS_READ_MAX_SIZE) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::unique_ptr<char[]> buffer = std::make_unique<char[]>(len);
+    std::streamsize         act_size;
+    int                     result = ramfs_pread(fd, pos, buffer.get(), len, act_size);
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+
+    if (result != FS_CODE_S_OK && result != FS_CODE_E_EOF) [[unlikely]] {
+      return;
+    }
+
+    set_ipc_data(msg, 1, act_size);
+    set_ipc_data_array(msg, 2, buffer.get(), act_size);
+  }
+
+  void pwrite(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_PWRITE);
+
+    id_cap_t fd = get_ipc_cap(msg, 2);
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::streampos pos = get_ipc_data(msg, 3);
+    size_t         len = get_ipc_data(msg, 4);
+    if (len > FS_WRITE_MAX_SIZE) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    const char* data = reinterpret_cast<const char*>(get_ipc_data_ptr(msg, 5));
+    if (data == nullptr) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::streamsize act_size;
+    int             result = ramfs_pwrite(fd, pos, std::string_view(data, len), act_size);
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+
+    if (result != FS_CODE_S_OK && result != FS_CODE_E_EOF) [[unlikely]] {
+      return;
+    }
+
+    set_ipc_data(msg, 1, act_size);
+  }
+
+  void readfile(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_READFILE);
+
+    size_t len = get_ipc_data(msg, 2);
+    if (len > FS_READ_MAX_SIZE) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    const char* c_path = reinterpret_cast<const char*>(get_ipc_data_ptr(msg, 3));
+    if (c_path == nullptr) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::unique_ptr<char[]> buffer = std::make_unique<char[]>(len);
+    std::streamsize         act_size;
+    size_t                  file_size;
+    int                     result = ramfs_readfile(c_path, buffer.get(), len, act_size, file_size);
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+
+    if (result != FS_CODE_S_OK) [[unlikely]] {
+      return;
+    }
+
+    set_ipc_data(msg, 1, file_size);
+    set_ipc_data(msg, 2, act_size);
+    set_ipc_data_array(msg, 3, buffer.get(), act_size);
+  }
+
+  void preadv(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_PREADV);
+
+    id_cap_t fd = get_ipc_cap(msg, 2);
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    fs_iovec iov[FS_IOV_MAX];
+    size_t   count;
+    size_t   total = fs_get_iovec(msg, 3, iov, &count, FS_READ_MAX_SIZE);
+    if (total == 0) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::unique_ptr<char[]> buffer = std::make_unique<char[]>(total);
+    std::streamsize         act_sizes[FS_IOV_MAX];
+    char*                   ptr    = buffer.get();
+    int                     result = FS_CODE_S_OK;
+
+    for (size_t i = 0; i < count; ++i) {
+      int seg_result = ramfs_pread(fd, iov[i].offset, ptr, iov[i].size, act_sizes[i]);
+      if (seg_result != FS_CODE_S_OK && seg_result != FS_CODE_E_EOF) [[unlikely]] {
+        result = seg_result;
+        break;
+      }
+      ptr += act_sizes[i];
+    }
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+
+    if (result != FS_CODE_S_OK) [[unlikely]] {
+      return;
+    }
+
+    set_ipc_data(msg, 1, count);
+    for (size_t i = 0; i < count; ++i) {
+      set_ipc_data(msg, 2 + i, act_sizes[i]);
+    }
+    set_ipc_data_array(msg, 2 + count, buffer.get(), ptr - buffer.get());
+  }
+
+  void pwritev(message_t* msg) {
+    assert(get_ipc_data(msg, 0) == FS_MSG_TYPE_PWRITEV);
+
+    id_cap_t fd = get_ipc_cap(msg, 2);
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    fs_iovec iov[FS_IOV_MAX];
+    size_t   count;
+    size_t   total = fs_get_iovec(msg, 3, iov, &count, FS_WRITE_MAX_SIZE);
+    if (total == 0) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    const char* data = reinterpret_cast<const char*>(get_ipc_data_ptr(msg, 4 + sizeof(fs_iovec) * count / sizeof(uintptr_t)));
+    if (data == nullptr) [[unlikely]] {
+      destroy_ipc_message(msg);
+      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
+      return;
+    }
+
+    std::streamsize total_act_size = 0;
+    int             result         = FS_CODE_S_OK;
+
+    for (size_t i = 0; i < count; ++i) {
+      std::streamsize act_size;
+      result = ramfs_pwrite(fd, iov[i].offset, std::string_view(data, iov[i].size), act_size);
+      if (result != FS_CODE_S_OK) [[unlikely]] {
+        if (result == FS_CODE_E_EOF) {
+          total_act_size += act_size;
+        }
+        break;
+      }
+      data += iov[i].size;
+      total_act_size += act_size;
+    }
+
+    destroy_ipc_message(msg);
+    set_ipc_data(msg, 0, result);
+
+    if (result != FS_CODE_S_OK && result != FS_CODE_E_EOF) [[unlikely]] {
+      return;
+    }
+
+    set_ipc_data(msg, 1, total_act_size);
+  }
+
   // clang-format off
 
   constexpr void (*const table[])(message_t*) = {
-    [0]                   = nullptr,
-    [FS_MSG_TYPE_MOUNT]   = nullptr,
-    [FS_MSG_TYPE_UNMOUNT] = nullptr,
-    [FS_MSG_TYPE_MOUNTED] = nullptr,
-    [FS_MSG_TYPE_INFO]    = info,
-    [FS_MSG_TYPE_CREATE]  = create,
-    [FS_MSG_TYPE_REMOVE]  = remove,
-    [FS_MSG_TYPE_OPEN]    = open,
-    [FS_MSG_TYPE_CLOSE]   = close,
-    [FS_MSG_TYPE_READ]    = read,
-    [FS_MSG_TYPE_WRITE]   = write,
-    [FS_MSG_TYPE_SEEK]    = seek,
-    [FS_MSG_TYPE_TELL]    = tell,
+    [0]                    = nullptr,
+    [FS_MSG_TYPE_MOUNT]    = nullptr,
+    [FS_MSG_TYPE_UNMOUNT]  = nullptr,
+    [FS_MSG_TYPE_MOUNTED]  = nullptr,
+    [FS_MSG_TYPE_INFO]     = info,
+    [FS_MSG_TYPE_CREATE]   = create,
+    [FS_MSG_TYPE_REMOVE]   = remove,
+    [FS_MSG_TYPE_OPEN]     = open,
+    [FS_MSG_TYPE_CLOSE]    = close,
+    [FS_MSG_TYPE_READ]     = read,
+    [FS_MSG_TYPE_WRITE]    = write,
+    [FS_MSG_TYPE_SEEK]     = seek,
+    [FS_MSG_TYPE_TELL]     = tell,
+    [FS_MSG_TYPE_MMAP]     = mmap,
+    [FS_MSG_TYPE_TRUNCATE] = truncate,
+    [FS_MSG_TYPE_READDIR]  = readdir,
+    [FS_MSG_TYPE_PREAD]    = pread,
+    [FS_MSG_TYPE_PWRITE]   = pwrite,
+    [FS_MSG_TYPE_PREADV]   = preadv,
+    [FS_MSG_TYPE_PWRITEV]  = pwritev,
+    [FS_MSG_TYPE_READFILE] = readfile,
   };
 
   // clang-format on
 
-  void proc_msg(message_t* msg) {
+  // The fs server presents ramfs_id_cap. A redirected client presents the channel id of its fd instead.
+  bool is_permitted(message_t* msg, uintptr_t msg_type) {
     id_cap_t id = get_ipc_cap(msg, 1);
     if (unwrap_sysret(sys_cap_type(id)) != CAP_ID) [[unlikely]] {
-      destroy_ipc_message(msg);
-      set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
-      return;
+      return false;
     }
 
-    if (unwrap_sysret(sys_id_cap_compare(id, ramfs_id_cap)) != 0) [[unlikely]] {
+    if (unwrap_sysret(sys_id_cap_compare(id, ramfs_id_cap)) == 0) {
+      return true;
+    }
+
+    if (!FS_IS_CHANNEL_MSG_TYPE(msg_type)) [[unlikely]] {
+      return false;
+    }
+
+    id_cap_t fd = get_ipc_cap(msg, 2);
+    if (unwrap_sysret(sys_cap_type(fd)) != CAP_ID) [[unlikely]] {
+      return false;
+    }
+
+    return ramfs_check_channel(fd, id);
+  }
+
+  void proc_msg(message_t* msg) {
+    uintptr_t msg_type = get_ipc_data(msg, 0);
+
+    if (!is_permitted(msg, msg_type)) [[unlikely]] {
       destroy_ipc_message(msg);
       set_ipc_data(msg, 0, FS_CODE_E_ILL_ARGS);
       return;
     }
 
-    uintptr_t msg_type = get_ipc_data(msg, 0);
-
     if (msg_type >= std::size(table)) [[unlikely]] {
       destroy_ipc_message(msg);
       set_ipc_data(msg, 0, FS_CODE_E_UNSUPPORTED);